@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+
+# check-trace.py
+
+import json
+import sys
+
+
+def check(events):
+    stacks = {}
+    for event in events:
+        stack = stacks.setdefault(event["tid"], [])
+        if event["ph"] == "B":
+            stack.append(event["name"])
+        elif event["ph"] == "E":
+            if not stack or stack[-1] != event["name"]:
+                return "Unmatched exit of {} on thread {}".format(event["name"], event["tid"])
+            stack.pop()
+        else:
+            return "Unknown phase {}".format(event["ph"])
+
+    for tid, stack in stacks.items():
+        if stack:
+            return "Unmatched enter of {} on thread {}".format(stack[-1], tid)
+    return None
+
+
+if __name__ == "__main__":
+    with open(sys.argv[1]) as trace_file:
+        events = json.load(trace_file)["traceEvents"]
+
+    error = check(events) if events else "No events"
+    if error:
+        sys.exit("{}: {}".format(sys.argv[1], error))
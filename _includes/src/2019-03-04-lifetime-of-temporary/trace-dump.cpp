@@ -0,0 +1,95 @@
+// trace-dump.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "trace-ring.hpp"
+
+template<typename T>
+static auto readRaw(std::istream &in) {
+    T value {};
+    in.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+}
+
+static auto &writeJsonString(std::ostream &out, const std::string &str) {
+    out << '"';
+    for (const auto c : str) {
+        if (c == '"' or c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+                << std::dec;
+        } else {
+            out << c;
+        }
+    }
+    return out << '"';
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace-ring-file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in {argv[1], std::ios::binary};
+    std::string magic(TraceRegistry::MAGIC.size(), 0);
+    in.read(magic.data(), magic.size());
+    if (not in or magic != TraceRegistry::MAGIC) {
+        std::cerr << "Not a trace ring file: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto ticks_per_us = readRaw<double>(in);
+
+    std::map<std::uint64_t, std::string> names;
+    for (auto n = readRaw<std::uint32_t>(in); in and n; --n) {
+        const auto id = readRaw<std::uint64_t>(in);
+        std::string name(readRaw<std::uint32_t>(in), 0);
+        in.read(name.data(), name.size());
+        names.emplace(id, std::move(name));
+    }
+
+    std::vector<TraceEvent> events;
+    std::vector<std::uint64_t> ids;
+    for (auto n = readRaw<std::uint32_t>(in); in and n; --n) {
+        readRaw<std::uint32_t>(in);
+        for (auto count = readRaw<std::uint64_t>(in); in and count; --count) {
+            ids.push_back(readRaw<std::uint64_t>(in));
+            TraceEvent event;
+            event.tsc = readRaw<std::uint64_t>(in);
+            event.tid = readRaw<std::uint32_t>(in);
+            event.phase = static_cast<TraceEvent::Phase>(readRaw<std::uint32_t>(in));
+            events.push_back(event);
+        }
+    }
+    if (not in) {
+        std::cerr << "Truncated trace ring file: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto base_tsc = UINT64_MAX;
+    for (const auto &event : events) {
+        base_tsc = std::min(base_tsc, event.tsc);
+    }
+
+    std::cout << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const auto &event = events[i];
+        std::cout << (i ? ",\n" : "\n") << "{\"name\":";
+        writeJsonString(std::cout, names[ids[i]]);
+        std::cout << ",\"ph\":\"" << static_cast<char>(event.phase) << "\",\"ts\":"
+                  << std::fixed << std::setprecision(3)
+                  << (event.tsc - base_tsc) / ticks_per_us << ",\"pid\":1,\"tid\":"
+                  << event.tid << '}';
+    }
+    std::cout << "\n]}" << std::endl;
+}
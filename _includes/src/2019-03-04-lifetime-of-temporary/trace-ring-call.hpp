@@ -0,0 +1,11 @@
+// trace-ring-call.hpp
+
+#pragma once
+
+// Force-included into the traced targets, so that the calls trace.hpp marks are recorded into
+// the ring instead of printed.
+#include "trace-ring.hpp"
+#include "trace.hpp"
+
+#undef TRACE_FUNCTION_CALL
+#define TRACE_FUNCTION_CALL() TRACE_SCOPE(__PRETTY_FUNCTION__)
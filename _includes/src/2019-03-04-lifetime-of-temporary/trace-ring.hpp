@@ -0,0 +1,215 @@
+// trace-ring.hpp
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <vector>
+
+inline auto ReadTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<std::uint64_t>(__rdtsc());
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct TraceEvent {
+    enum class Phase : std::uint32_t {
+        enter = 'B',
+        exit = 'E',
+    };
+
+    const char *id = nullptr;
+    std::uint64_t tsc = 0;
+    std::uint32_t tid = 0;
+    Phase phase = Phase::enter;
+};
+
+class TraceRing {
+public:
+    static constexpr std::uint64_t CAPACITY = 1 << 14;
+
+    TraceRing(const std::uint32_t tid, const std::atomic<bool> &recording) :
+        m_tid(tid), m_recording(recording) {
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0);
+    }
+
+    // Records nothing once the registry stops recording, so a dump never reads a ring that
+    // its thread is still writing.
+    void Record(const char *id, const TraceEvent::Phase phase) {
+        m_writing.store(true);
+        if (m_recording.load()) {
+            auto &event = m_events[m_next++ & (CAPACITY - 1)];
+            event.id = id;
+            event.tsc = ReadTsc();
+            event.tid = m_tid;
+            event.phase = phase;
+        }
+        m_writing.store(false, std::memory_order_release);
+    }
+
+    void WaitForWriter() const {
+        while (m_writing.load(std::memory_order_acquire)) {
+        }
+    }
+
+    template<typename Function>
+    void ForEach(Function &&f) const {
+        const auto first = m_next > CAPACITY ? m_next - CAPACITY : 0;
+        for (auto i = first; i < m_next; ++i) {
+            f(m_events[i & (CAPACITY - 1)]);
+        }
+    }
+
+    auto Size() const {
+        return m_next > CAPACITY ? CAPACITY : m_next;
+    }
+
+    auto Tid() const {
+        return m_tid;
+    }
+
+private:
+    std::uint32_t m_tid = 0;
+    const std::atomic<bool> &m_recording;
+    std::atomic<bool> m_writing {false};
+    std::uint64_t m_next = 0;
+    TraceEvent m_events[CAPACITY];
+};
+
+/*
+ * Binary layout of a dump, all integers in host byte order:
+ *   "TRCRING1" | double ticks_per_us | u32 #strings | {u64 id, u32 size, bytes}...
+ *   u32 #rings | {u32 tid, u64 #events, {u64 id, u64 tsc, u32 tid, u32 phase}...}...
+ */
+class TraceRegistry {
+public:
+    static constexpr std::string_view MAGIC = "TRCRING1";
+
+    // Never destroyed, as other threads may still record after the exit handlers run.
+    static TraceRegistry &Instance() {
+        static auto *registry = [] {
+            auto *registry = new TraceRegistry;
+            std::atexit([] {
+                if (const auto *pathname = std::getenv("TRACE_RING_FILE")) {
+                    Instance().Dump(pathname);
+                }
+            });
+            return registry;
+        }();
+        return *registry;
+    }
+
+    static auto &LocalRing() {
+        thread_local auto *ring = Instance().newRing();
+        return *ring;
+    }
+
+    // Stops recording, for good, and writes out the rings.
+    bool Dump(const char *pathname) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        m_recording.store(false);
+        for (const auto &a_ring : m_rings) {
+            a_ring->WaitForWriter();
+        }
+
+        std::ofstream out {pathname, std::ios::binary};
+        out.write(MAGIC.data(), MAGIC.size());
+        writeRaw(out, ticksPerMicrosecond());
+
+        std::set<const char *> ids;
+        for (const auto &a_ring : m_rings) {
+            a_ring->ForEach([&ids](const auto &event) {
+                ids.insert(event.id);
+            });
+        }
+        writeRaw(out, static_cast<std::uint32_t>(ids.size()));
+        for (const auto *id : ids) {
+            const std::string_view name {id};
+            writeRaw(out, reinterpret_cast<std::uint64_t>(id));
+            writeRaw(out, static_cast<std::uint32_t>(name.size()));
+            out.write(name.data(), name.size());
+        }
+
+        writeRaw(out, static_cast<std::uint32_t>(m_rings.size()));
+        for (const auto &a_ring : m_rings) {
+            writeRaw(out, a_ring->Tid());
+            writeRaw(out, static_cast<std::uint64_t>(a_ring->Size()));
+            a_ring->ForEach([&out](const auto &event) {
+                writeRaw(out, reinterpret_cast<std::uint64_t>(event.id));
+                writeRaw(out, event.tsc);
+                writeRaw(out, event.tid);
+                writeRaw(out, static_cast<std::uint32_t>(event.phase));
+            });
+        }
+
+        return static_cast<bool>(out);
+    }
+
+private:
+    TraceRegistry() = default;
+
+    TraceRing *newRing() {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        m_rings.push_back(std::make_unique<TraceRing>(m_rings.size() + 1, m_recording));
+        return m_rings.back().get();
+    }
+
+    double ticksPerMicrosecond() const {
+        constexpr auto MIN_CALIBRATION = std::chrono::milliseconds(10);
+        while (std::chrono::steady_clock::now() - m_start_time < MIN_CALIBRATION) {
+        }
+
+        const auto ticks = ReadTsc() - m_start_tsc;
+        const std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - m_start_time;
+        return ticks / elapsed.count();
+    }
+
+    template<typename T>
+    static void writeRaw(std::ostream &out, const T value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<TraceRing>> m_rings;
+    std::atomic<bool> m_recording {true};
+
+    const std::chrono::steady_clock::time_point m_start_time =
+        std::chrono::steady_clock::now();
+    const std::uint64_t m_start_tsc = ReadTsc();
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char *id) : m_id(id) {
+        TraceRegistry::LocalRing().Record(m_id, TraceEvent::Phase::enter);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    ~TraceScope() {
+        TraceRegistry::LocalRing().Record(m_id, TraceEvent::Phase::exit);
+    }
+
+private:
+    const char *m_id = nullptr;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(id) const TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(id)
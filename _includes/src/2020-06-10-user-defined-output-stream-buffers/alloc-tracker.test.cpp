@@ -0,0 +1,115 @@
+// alloc-tracker.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "alloc-tracker.hpp"
+#include "hex-out-stream-buffer.hpp"
+
+
+class AllocTrackerTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        AllocTracker::Instance().Reset();
+        s_violations = 0;
+        NoAllocationGuard::SetHandler([](const char *, const std::uint64_t allocations) {
+            s_violations += allocations;
+        });
+    }
+
+    void TearDown() override {
+        AllocTracker::Instance().Stop();
+    }
+
+    static inline std::uint64_t s_violations = 0;
+};
+
+TEST_F(AllocTrackerTests, TestIsInstalled) {
+    EXPECT_TRUE(AllocTracker::Installed());
+}
+
+TEST_F(AllocTrackerTests, TestFindsToHexSites) {
+    constexpr auto CALLS = 1000;
+    constexpr auto WIDE = 32;
+    auto &tracker = AllocTracker::Instance();
+    tracker.Start(0);
+    for (auto i = 0; i < CALLS; ++i) {
+        ToHex(static_cast<unsigned>(i), WIDE);
+    }
+    tracker.Stop();
+
+    std::uint64_t count = 0;
+    for (const auto &a_site : tracker.Sites()) {
+        for (auto *a_frame : a_site.frames) {
+            if (Symbolize(a_frame).find("ToHex") != std::string::npos) {
+                count += a_site.count;
+                break;
+            }
+        }
+    }
+    EXPECT_LE(CALLS, count);
+    EXPECT_EQ(0, tracker.Dropped());
+}
+
+TEST_F(AllocTrackerTests, TestWeightsSamplesBySize) {
+    constexpr auto SIZE = 64;
+    constexpr auto COUNT = 20000;
+    std::vector<std::unique_ptr<char[]>> allocations;
+    allocations.reserve(COUNT);
+
+    auto &tracker = AllocTracker::Instance();
+    tracker.Start(4096);
+    for (auto i = 0; i < COUNT; ++i) {
+        allocations.push_back(std::make_unique<char[]>(SIZE));
+    }
+    tracker.Stop();
+
+    std::uint64_t count = 0, bytes = 0;
+    for (const auto &a_site : tracker.Sites()) {
+        count += a_site.count;
+        bytes += a_site.bytes;
+    }
+    EXPECT_NEAR(COUNT, count, COUNT / 5);
+    EXPECT_NEAR(COUNT * SIZE, bytes, COUNT * SIZE / 5);
+}
+
+TEST_F(AllocTrackerTests, TestGuardPassesBufferedOutput) {
+    const auto null_fd = ::open("/dev/null", O_WRONLY);
+    {
+        HexOutBuf buffer {null_fd};
+        std::ostream out(&buffer);
+
+        NoAllocationGuard guard {"HexOutBuf buffered output"};
+        for (auto i = 0; i < 100; ++i) {
+            out << 'a';
+        }
+        EXPECT_EQ(0, guard.Allocations());
+    }
+    ::close(null_fd);
+
+    EXPECT_EQ(0, s_violations);
+}
+
+TEST_F(AllocTrackerTests, TestGuardPassesNarrowToHex) {
+    {
+        NoAllocationGuard guard {"ToHex"};
+        EXPECT_EQ("61", ToHex('a', 2));
+    }
+
+    EXPECT_EQ(0, s_violations);
+}
+
+TEST_F(AllocTrackerTests, TestGuardReportsAllocations) {
+    {
+        NoAllocationGuard guard {"ToHex"};
+        ToHex('a', 32);
+    }
+
+    EXPECT_LT(0, s_violations);
+}
@@ -0,0 +1,41 @@
+// bench-utils.hpp
+
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <ostream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+class StdoutToDevNull {
+public:
+    StdoutToDevNull() : m_original(dup(STDOUT_FILENO)) {
+        const auto null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+
+    StdoutToDevNull(const StdoutToDevNull &) = delete;
+    StdoutToDevNull &operator=(const StdoutToDevNull &) = delete;
+
+    ~StdoutToDevNull() {
+        dup2(m_original, STDOUT_FILENO);
+        close(m_original);
+    }
+
+private:
+    int m_original = -1;
+};
+
+inline void WriteBlocks(benchmark::State &state, std::ostream &out) {
+    const std::string block(state.range(0), 'x');
+    for (auto _ : state) {
+        out.write(block.data(), block.size());
+    }
+    out.flush();
+
+    state.SetBytesProcessed(state.iterations() * block.size());
+}
@@ -0,0 +1,132 @@
+// fd-stream-buffer.bench.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "fd-stream-buffer.hpp"
+
+constexpr std::size_t MIB = 1024 * 1024;
+
+// A file of the given number of MiB, and a path to copy it to, both removed afterwards.
+class CopyFiles {
+public:
+    explicit CopyFiles(const std::size_t mib) :
+        m_directory(std::filesystem::temp_directory_path() /
+                    ("fd-stream-buffer.bench." + std::to_string(getpid()))) {
+        std::filesystem::create_directories(m_directory);
+
+        FdOutBuf source {Source().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+        const std::string block(MIB, 'x');
+        for (std::size_t i = 0; i < mib; ++i) {
+            source.sputn(block.data(), block.size());
+        }
+    }
+
+    CopyFiles(const CopyFiles &) = delete;
+    CopyFiles &operator=(const CopyFiles &) = delete;
+
+    ~CopyFiles() {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    std::string Source() const {
+        return m_directory / "source";
+    }
+
+    std::string Target() const {
+        return m_directory / "target";
+    }
+
+private:
+    std::filesystem::path m_directory;
+};
+
+// A pipe whose reader moves everything to /dev/null without copying it.
+class DrainedPipe {
+public:
+    DrainedPipe() {
+        pipe2(m_fds, O_CLOEXEC);
+        m_reader = std::thread {[read_fd = m_fds[0]] {
+            const auto null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+            while (splice(read_fd, nullptr, null_fd, nullptr, MIB, SPLICE_F_MOVE) > 0) {
+            }
+            close(null_fd);
+        }};
+    }
+
+    DrainedPipe(const DrainedPipe &) = delete;
+    DrainedPipe &operator=(const DrainedPipe &) = delete;
+
+    ~DrainedPipe() {
+        close(m_fds[1]);
+        m_reader.join();
+        close(m_fds[0]);
+    }
+
+    int WriteFd() const {
+        return m_fds[1];
+    }
+
+private:
+    int m_fds[2] = {-1, -1};
+    std::thread m_reader;
+};
+
+static void BM_FileToFileFilebuf(benchmark::State &state) {
+    const CopyFiles files {static_cast<std::size_t>(state.range(0))};
+    for (auto _ : state) {
+        std::ifstream in {files.Source(), std::ios::binary};
+        std::ofstream out {files.Target(), std::ios::binary | std::ios::trunc};
+        out << in.rdbuf();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) * MIB);
+}
+BENCHMARK(BM_FileToFileFilebuf)->ArgName("MiB")->Arg(64)->MinTime(2)->Unit(benchmark::kMillisecond);
+
+static void BM_FileToFileFdBuf(benchmark::State &state) {
+    const CopyFiles files {static_cast<std::size_t>(state.range(0))};
+    for (auto _ : state) {
+        FdIStream in {files.Source().c_str()};
+        FdOutBuf buffer {files.Target().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+        std::ostream out(&buffer);
+        out << in.rdbuf();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) * MIB);
+}
+BENCHMARK(BM_FileToFileFdBuf)->ArgName("MiB")->Arg(64)->MinTime(2)->Unit(benchmark::kMillisecond);
+
+static void BM_FileToPipeFilebuf(benchmark::State &state) {
+    const CopyFiles files {static_cast<std::size_t>(state.range(0))};
+    const DrainedPipe a_pipe;
+    for (auto _ : state) {
+        std::ifstream in {files.Source(), std::ios::binary};
+        std::ofstream out {"/dev/fd/" + std::to_string(a_pipe.WriteFd()), std::ios::binary};
+        out << in.rdbuf();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) * MIB);
+}
+BENCHMARK(BM_FileToPipeFilebuf)->ArgName("MiB")->Arg(64)->MinTime(2)->Unit(benchmark::kMillisecond);
+
+static void BM_FileToPipeFdBuf(benchmark::State &state) {
+    const CopyFiles files {static_cast<std::size_t>(state.range(0))};
+    const DrainedPipe a_pipe;
+    for (auto _ : state) {
+        FdIStream in {files.Source().c_str()};
+        FdOutBuf buffer {a_pipe.WriteFd()};
+        std::ostream out(&buffer);
+        out << in.rdbuf();
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) * MIB);
+}
+BENCHMARK(BM_FileToPipeFdBuf)->ArgName("MiB")->Arg(64)->MinTime(2)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,331 @@
+// fd-stream-buffer.hpp
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+class FdInBuf;
+
+// Buffers the output to a file descriptor, and writes a block at least as large as the buffer
+// straight from the caller.
+class FdOutBuf : public std::streambuf {
+public:
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    explicit FdOutBuf(const int fd = STDOUT_FILENO,
+                      const std::size_t buffer_size = DEFAULT_BUFFER_SIZE) :
+        m_fd(fd), m_own(false), m_buffer(std::max<std::size_t>(buffer_size, 1)) {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    FdOutBuf(const char *pathname,
+             const int flags,
+             const mode_t mode = 0,
+             const std::size_t buffer_size = DEFAULT_BUFFER_SIZE) :
+        FdOutBuf(open(pathname, flags | O_CLOEXEC, mode), buffer_size) {
+        m_own = true;
+    }
+
+    FdOutBuf(const FdOutBuf &) = delete;
+    FdOutBuf &operator=(const FdOutBuf &) = delete;
+
+    virtual ~FdOutBuf() {
+        sync();
+        if (IsOpen() and m_own) {
+            close(m_fd);
+        }
+    }
+
+    bool IsOpen() const {
+        return m_fd != INVALID_FD;
+    }
+
+    int Fd() const {
+        return m_fd;
+    }
+
+    friend std::streamsize Transfer(FdInBuf &in, FdOutBuf &out);
+
+protected:
+    static constexpr int INVALID_FD = -1;
+
+    bool flushBuffer() {
+        const auto n = pptr() - pbase();
+        const auto written = writeAll(pbase(), n);
+        std::memmove(pbase(), pbase() + written, n - written);
+        setp(pbase(), epptr());
+        pbump(static_cast<int>(n - written));
+
+        return written == n;
+    }
+
+    std::streamsize writeAll(const char *s, const std::streamsize n) {
+        std::streamsize written = 0;
+        while (written < n) {
+            const auto result = write(m_fd, s + written, n - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            written += result;
+        }
+
+        return written;
+    }
+
+    virtual int_type overflow(int_type c) override {
+        if (not flushBuffer()) {
+            return traits_type::eof();
+        }
+
+        if (not traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    virtual std::streamsize xsputn(const char *s, std::streamsize n) override {
+        if (n <= epptr() - pptr()) {
+            std::memcpy(pptr(), s, n);
+            pbump(static_cast<int>(n));
+            return n;
+        }
+
+        if (not flushBuffer()) {
+            return 0;
+        }
+        if (n < static_cast<std::streamsize>(m_buffer.size())) {
+            std::memcpy(pptr(), s, n);
+            pbump(static_cast<int>(n));
+            return n;
+        }
+
+        return writeAll(s, n);
+    }
+
+    virtual int sync() override {
+        return flushBuffer() ? 0 : -1;
+    }
+
+private:
+    int m_fd = INVALID_FD;
+    bool m_own = false;
+    std::vector<char> m_buffer;
+};
+
+// Buffers the input from a file descriptor, and reads a block at least as large as the buffer
+// straight into the caller. A failed read ends the input like the end of the file does, and
+// leaves its errno in Error().
+class FdInBuf : public std::streambuf {
+public:
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    explicit FdInBuf(const int fd = STDIN_FILENO,
+                     const std::size_t buffer_size = DEFAULT_BUFFER_SIZE) :
+        m_fd(fd), m_own(false), m_buffer(std::max<std::size_t>(buffer_size, 1)) {
+        setg(m_buffer.data(), m_buffer.data(), m_buffer.data());
+    }
+
+    FdInBuf(const char *pathname,
+            const int flags = O_RDONLY,
+            const std::size_t buffer_size = DEFAULT_BUFFER_SIZE) :
+        FdInBuf(open(pathname, flags | O_CLOEXEC), buffer_size) {
+        m_own = true;
+    }
+
+    FdInBuf(const FdInBuf &) = delete;
+    FdInBuf &operator=(const FdInBuf &) = delete;
+
+    virtual ~FdInBuf() {
+        if (IsOpen() and m_own) {
+            close(m_fd);
+        }
+    }
+
+    bool IsOpen() const {
+        return m_fd != INVALID_FD;
+    }
+
+    int Fd() const {
+        return m_fd;
+    }
+
+    // The errno of the first read that failed, or 0.
+    int Error() const {
+        return m_error;
+    }
+
+    friend std::streamsize Transfer(FdInBuf &in, FdOutBuf &out);
+
+protected:
+    static constexpr int INVALID_FD = -1;
+
+    // Returns -1 if the read fails.
+    std::streamsize readSome(char *s, const std::streamsize n) {
+        while (true) {
+            const auto result = read(m_fd, s, n);
+            if (result >= 0) {
+                return result;
+            }
+            if (errno != EINTR) {
+                m_error = m_error ? m_error : errno;
+                return -1;
+            }
+        }
+    }
+
+    virtual int_type underflow() override {
+        if (gptr() == egptr()) {
+            const auto n = readSome(m_buffer.data(), m_buffer.size());
+            if (n < 0) {
+                return traits_type::eof();
+            }
+            setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + n);
+        }
+
+        return gptr() == egptr() ? traits_type::eof() : traits_type::to_int_type(*gptr());
+    }
+
+    virtual std::streamsize xsgetn(char *s, std::streamsize n) override {
+        const auto buffered = std::min<std::streamsize>(n, egptr() - gptr());
+        std::memcpy(s, gptr(), buffered);
+        gbump(static_cast<int>(buffered));
+
+        if (n - buffered < static_cast<std::streamsize>(m_buffer.size())) {
+            return buffered + std::streambuf::xsgetn(s + buffered, n - buffered);
+        }
+
+        auto got = buffered;
+        while (got < n) {
+            const auto result = readSome(s + got, n - got);
+            if (result <= 0) {
+                break;
+            }
+            got += result;
+        }
+
+        return got;
+    }
+
+private:
+    int m_fd = INVALID_FD;
+    bool m_own = false;
+    std::vector<char> m_buffer;
+    int m_error = 0;
+};
+
+// Copies the rest of the input to the output in the kernel: splice() when either end is a
+// pipe, else copy_file_range() or sendfile(), and read() and write() when none of them can.
+// Returns the number of bytes copied, or -1 if it fails before copying any.
+inline std::streamsize Transfer(FdInBuf &in, FdOutBuf &out) {
+    if (not out.flushBuffer()) {
+        return -1;
+    }
+
+    auto copied = out.writeAll(in.gptr(), in.egptr() - in.gptr());
+    if (copied != in.egptr() - in.gptr()) {
+        in.gbump(static_cast<int>(copied));
+        return copied ? copied : -1;
+    }
+    in.setg(in.eback(), in.egptr(), in.egptr());
+
+    const auto isPipe = [](const int fd) {
+        struct stat status {};
+        return fstat(fd, &status) == 0 and S_ISFIFO(status.st_mode);
+    };
+    enum Method {
+        with_splice,
+        with_copy_file_range,
+        with_sendfile,
+        with_buffer,
+    };
+    auto method = isPipe(in.m_fd) or isPipe(out.m_fd) ? with_splice : with_copy_file_range;
+    auto started = false;
+
+    constexpr std::size_t CHUNK = std::size_t {1} << 30;
+    while (true) {
+        ssize_t result = 0;
+        switch (method) {
+        case with_splice:
+            result = splice(in.m_fd, nullptr, out.m_fd, nullptr, CHUNK, SPLICE_F_MOVE);
+            break;
+        case with_copy_file_range:
+            result = copy_file_range(in.m_fd, nullptr, out.m_fd, nullptr, CHUNK, 0);
+            break;
+        case with_sendfile:
+            result = sendfile(out.m_fd, in.m_fd, nullptr, CHUNK);
+            break;
+        case with_buffer:
+            result = in.readSome(out.pbase(), out.epptr() - out.pbase());
+            if (result > 0 and out.writeAll(out.pbase(), result) != result) {
+                result = -1;
+            }
+            break;
+        }
+
+        if (result > 0) {
+            copied += result;
+            started = true;
+        } else if (result == 0) {
+            return copied;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (not started and method != with_buffer) {
+            method = static_cast<Method>(method + 1);
+        } else {
+            return copied ? copied : -1;
+        }
+    }
+}
+
+// Streams an FdInBuf into an FdOutBuf with Transfer(), and into anything else as usual. Fails
+// when nothing is copied, or when a read fails in between.
+inline std::ostream &operator<<(std::ostream &out, FdInBuf *in) {
+    auto *fd_out = dynamic_cast<FdOutBuf *>(out.rdbuf());
+    if (not in or not fd_out) {
+        out << static_cast<std::streambuf *>(in);
+    } else if (const std::ostream::sentry guard {out}; guard and Transfer(*in, *fd_out) <= 0) {
+        out.setstate(std::ios_base::failbit);
+    }
+
+    if (in and in->Error()) {
+        out.setstate(std::ios_base::failbit);
+    }
+    return out;
+}
+
+// Like std::ifstream, its rdbuf() is typed, so out << in.rdbuf() finds the operator above.
+class FdIStream : public std::istream {
+public:
+    template<typename... Args>
+    explicit FdIStream(Args &&...args) :
+        std::istream(nullptr), m_buffer(std::forward<Args>(args)...) {
+        init(&m_buffer);
+        if (not m_buffer.IsOpen()) {
+            setstate(std::ios_base::failbit);
+        }
+    }
+
+    FdInBuf *rdbuf() const {
+        return const_cast<FdInBuf *>(&m_buffer);
+    }
+
+private:
+    FdInBuf m_buffer;
+};
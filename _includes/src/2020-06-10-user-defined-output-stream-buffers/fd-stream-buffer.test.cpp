@@ -0,0 +1,178 @@
+// fd-stream-buffer.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "fd-stream-buffer.hpp"
+
+
+class FdStreamBufferTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto *test = ::testing::UnitTest::GetInstance()->current_test_info();
+        m_directory = std::filesystem::temp_directory_path() /
+                      (std::string {"fd-stream-buffer."} + test->name() + '.' +
+                       std::to_string(getpid()));
+        std::filesystem::create_directories(m_directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    std::string path(const char *name) const {
+        return m_directory / name;
+    }
+
+    std::string writeFile(const char *name, const std::string &content) const {
+        std::ofstream {path(name), std::ios::binary} << content;
+        return path(name);
+    }
+
+    static std::string readFile(const std::string &a_path) {
+        std::ifstream in {a_path, std::ios::binary};
+        return {std::istreambuf_iterator<char> {in}, {}};
+    }
+
+    static std::string pattern(const std::size_t size) {
+        std::string content;
+        for (std::size_t i = 0; i < size; ++i) {
+            content += static_cast<char>('a' + i % 26);
+        }
+        return content;
+    }
+
+    std::filesystem::path m_directory;
+};
+
+TEST_F(FdStreamBufferTests, TestWritesSmallAndLargeBlocks) {
+    const auto large = pattern(100);
+    {
+        FdOutBuf buffer {path("out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644, 16};
+        std::ostream out(&buffer);
+        out << "abc" << large << 'z';
+    }
+
+    EXPECT_EQ("abc" + large + 'z', readFile(path("out")));
+}
+
+TEST_F(FdStreamBufferTests, TestReadsSmallAndLargeBlocks) {
+    const auto content = pattern(200);
+    FdIStream in {writeFile("in", content).c_str(), O_RDONLY, 16};
+
+    std::string head(3, '\0');
+    std::string large(100, '\0');
+    in.read(head.data(), head.size());
+    in.read(large.data(), large.size());
+    const std::string rest {std::istreambuf_iterator<char> {in}, {}};
+
+    EXPECT_EQ(content, head + large + rest);
+}
+
+TEST_F(FdStreamBufferTests, TestCopiesFileToFile) {
+    const auto content = pattern(1 << 20);
+    FdIStream in {writeFile("in", content).c_str()};
+    std::string head(10, '\0');
+    in.read(head.data(), head.size());
+    {
+        FdOutBuf buffer {path("out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+        std::ostream out(&buffer);
+        out << "header";
+        EXPECT_TRUE(out << in.rdbuf());
+    }
+
+    EXPECT_EQ("header" + content.substr(head.size()), readFile(path("out")));
+}
+
+TEST_F(FdStreamBufferTests, TestCopiesFileToPipe) {
+    const auto content = pattern(1 << 20);
+    int fds[2] = {};
+    ASSERT_EQ(0, pipe(fds));
+
+    std::string received;
+    std::thread reader {[&received, read_fd = fds[0]] {
+        FdIStream in {read_fd};
+        received.assign(std::istreambuf_iterator<char> {in}, {});
+    }};
+    {
+        FdIStream in {writeFile("in", content).c_str()};
+        FdOutBuf buffer {fds[1]};
+        std::ostream out(&buffer);
+        EXPECT_TRUE(out << in.rdbuf());
+    }
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+
+    EXPECT_EQ(content, received);
+}
+
+TEST_F(FdStreamBufferTests, TestCopiesPipeToFile) {
+    const auto content = pattern(1 << 20);
+    int fds[2] = {};
+    ASSERT_EQ(0, pipe(fds));
+
+    std::thread writer {[&content, write_fd = fds[1]] {
+        {
+            FdOutBuf buffer {write_fd};
+            buffer.sputn(content.data(), content.size());
+        }
+        close(write_fd);
+    }};
+    {
+        FdIStream in {fds[0]};
+        FdOutBuf buffer {path("out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+        std::ostream out(&buffer);
+        EXPECT_TRUE(out << in.rdbuf());
+    }
+    writer.join();
+    close(fds[0]);
+
+    EXPECT_EQ(content, readFile(path("out")));
+}
+
+TEST_F(FdStreamBufferTests, TestStreamsIntoOtherBuffers) {
+    const auto content = pattern(1000);
+    FdIStream in {writeFile("in", content).c_str()};
+    std::ostringstream out;
+    out << in.rdbuf();
+
+    EXPECT_EQ(content, out.str());
+}
+
+TEST_F(FdStreamBufferTests, TestFailsOnEmptyInput) {
+    FdIStream in {writeFile("in", "").c_str()};
+    FdOutBuf buffer {path("out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+    std::ostream out(&buffer);
+
+    EXPECT_FALSE(out << in.rdbuf());
+}
+
+TEST_F(FdStreamBufferTests, TestReportsReadErrors) {
+    FdIStream in {m_directory.c_str()};
+    std::string word;
+    EXPECT_FALSE(in >> word);
+    EXPECT_EQ(EISDIR, in.rdbuf()->Error());
+
+    FdIStream large {m_directory.c_str()};
+    std::string block(2 * FdInBuf::DEFAULT_BUFFER_SIZE, 0);
+    large.read(block.data(), block.size());
+    EXPECT_EQ(0, large.gcount());
+    EXPECT_EQ(EISDIR, large.rdbuf()->Error());
+
+    FdIStream copied {m_directory.c_str()};
+    FdOutBuf buffer {path("out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644};
+    std::ostream out(&buffer);
+    EXPECT_FALSE(out << copied.rdbuf());
+    EXPECT_EQ(EISDIR, copied.rdbuf()->Error());
+}
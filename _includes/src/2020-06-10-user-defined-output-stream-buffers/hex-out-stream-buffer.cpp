@@ -1,10 +1,32 @@
 // hex-out-stream-buffer.cpp
 
+#include "flush-on-shutdown.hpp"
 #include "hex-out-stream-buffer.hpp"
+#include "perf-region.hpp"
 #include "test-utils.hpp"
 
+// Counts the hardware events of the flushes, which the post's HexOutBuf leaves out.
+class InstrumentedHexOutBuf : public HexOutBuf {
+public:
+    // Flushes here, since the sync() in ~HexOutBuf() no longer reaches the override.
+    virtual ~InstrumentedHexOutBuf() {
+        sync();
+    }
+
+protected:
+    virtual int_type overflow(int_type c) override {
+        PERF_REGION("HexOutBuf::overflow");
+        return HexOutBuf::overflow(c);
+    }
+
+    virtual int sync() override {
+        PERF_REGION("HexOutBuf::sync");
+        return HexOutBuf::sync();
+    }
+};
+
 int main() {
-    HexOutBuf buffer;
+    FlushOnShutdown<InstrumentedHexOutBuf> buffer;
     std::ostream out(&buffer);
 
     TestHelper(out);
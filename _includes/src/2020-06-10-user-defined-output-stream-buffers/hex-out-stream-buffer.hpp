@@ -21,6 +21,9 @@ public:
         std::streambuf::setp(m_buffer.begin(), m_buffer.begin() + SIZE / WIDTH - 1);
     }
 
+    HexOutBuf(const HexOutBuf &) = delete;
+    HexOutBuf &operator=(const HexOutBuf &) = delete;
+
     virtual ~HexOutBuf() {
         sync();
     }
@@ -0,0 +1,13 @@
+// hex-out-stream-nobuf-improved.bench.cpp
+
+#include "bench-utils.hpp"
+#include "hex-out-stream-nobuf-improved.hpp"
+
+static void BM_HexOutBufNobufImproved(benchmark::State &state) {
+    const StdoutToDevNull redirect;
+    HexOutBuf buffer {STDOUT_FILENO};
+    std::ostream out(&buffer);
+
+    WriteBlocks(state, out);
+}
+BENCHMARK(BM_HexOutBufNobufImproved)->ArgName("block")->Arg(1)->Arg(64)->Arg(4096);
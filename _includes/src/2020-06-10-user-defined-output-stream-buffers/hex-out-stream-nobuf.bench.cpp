@@ -0,0 +1,13 @@
+// hex-out-stream-nobuf.bench.cpp
+
+#include "bench-utils.hpp"
+#include "hex-out-stream-nobuf.hpp"
+
+static void BM_HexOutBufNobuf(benchmark::State &state) {
+    const StdoutToDevNull redirect;
+    HexOutBuf buffer;
+    std::ostream out(&buffer);
+
+    WriteBlocks(state, out);
+}
+BENCHMARK(BM_HexOutBufNobuf)->ArgName("block")->Arg(1)->Arg(64)->Arg(4096);
@@ -0,0 +1,93 @@
+// sampling-profiler.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hex-out-stream-nobuf.hpp"
+#include "sampling-profiler.hpp"
+#include "test-utils.hpp"
+
+
+// Descends from the frame named like root into its child with the most samples, down to a leaf,
+// the way one reads the widest tower of a flame graph.
+std::vector<std::string> HotPath(const std::string &folded, const std::string &root) {
+    std::vector<std::pair<std::vector<std::string>, std::uint64_t>> stacks;
+    std::istringstream in {folded};
+    for (std::string a_line; std::getline(in, a_line);) {
+        const auto count_at = a_line.rfind(' ');
+        std::vector<std::string> frames;
+        std::istringstream frames_in {a_line.substr(0, count_at)};
+        for (std::string a_frame; std::getline(frames_in, a_frame, ';');) {
+            if (not frames.empty() or a_frame.find(root) != std::string::npos) {
+                frames.push_back(a_frame);
+            }
+        }
+        stacks.emplace_back(frames, std::stoull(a_line.substr(count_at + 1)));
+    }
+
+    std::vector<std::string> path;
+    for (;;) {
+        std::map<std::string, std::uint64_t> children;
+        for (const auto &[frames, count] : stacks) {
+            if (frames.size() > path.size() and
+                std::equal(path.begin(), path.end(), frames.begin())) {
+                children[frames[path.size()]] += count;
+            }
+        }
+        if (children.empty()) {
+            return path;
+        }
+        const auto hottest = std::max_element(children.begin(), children.end(),
+                                              [](const auto &a, const auto &b) {
+                                                  return a.second < b.second;
+                                              });
+        path.push_back(hottest->first);
+    }
+}
+
+TEST(SamplingProfilerTests, TestFindsToHexInHexOutBufNobuf) {
+    constexpr std::uint64_t SAMPLES = 200;
+    constexpr std::chrono::minutes TIMEOUT {1};
+
+    const auto original = ::dup(STDOUT_FILENO);
+    const auto null_fd = ::open("/dev/null", O_WRONLY);
+    ::dup2(null_fd, STDOUT_FILENO);
+    ::close(null_fd);
+
+    auto &profiler = SamplingProfiler::Instance();
+    const auto first = profiler.Samples();
+    profiler.Start();
+    {
+        HexOutBuf buffer;
+        std::ostream out(&buffer);
+        const auto end = std::chrono::steady_clock::now() + TIMEOUT;
+        while (profiler.Samples() - first < SAMPLES and std::chrono::steady_clock::now() < end) {
+            TestHelper(out);
+        }
+    }
+    profiler.Stop();
+
+    ::dup2(original, STDOUT_FILENO);
+    ::close(original);
+
+    std::ostringstream folded;
+    profiler.WriteFolded(folded);
+    const auto hot_path = HotPath(folded.str(), "TestHelper");
+    const auto to_hex = std::find_if(hot_path.begin(), hot_path.end(), [](const auto &frame) {
+        return frame.find("ToHex") != std::string::npos;
+    });
+
+    EXPECT_LE(SAMPLES, profiler.Samples() - first);
+    EXPECT_GT(0.02, profiler.Overhead());
+    EXPECT_NE(hot_path.end(), to_hex) << folded.str();
+}
@@ -0,0 +1,64 @@
+// bench-utils.hpp
+
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <istream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+class HexTempFile {
+public:
+    explicit HexTempFile(const std::size_t size) {
+        char pathname[] = "/tmp/hex-in-bench-XXXXXX";
+        m_fd = mkstemp(pathname);
+        unlink(pathname);
+
+        const std::string hex = "303a09455e69";
+        for (std::size_t i = 0; i < size * 2; i += hex.size()) {
+            const auto n = std::min(hex.size(), size * 2 - i);
+            if (write(m_fd, hex.data(), n) != static_cast<ssize_t>(n)) {
+                break;
+            }
+        }
+    }
+
+    HexTempFile(const HexTempFile &) = delete;
+    HexTempFile &operator=(const HexTempFile &) = delete;
+
+    ~HexTempFile() {
+        close(m_fd);
+    }
+
+    auto Rewind() const {
+        return lseek(m_fd, 0, SEEK_SET);
+    }
+
+    auto Fd() const {
+        return m_fd;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+template<typename Buffer>
+void ReadAll(benchmark::State &state) {
+    const std::size_t size = state.range(0);
+    const HexTempFile file {size};
+    std::string decoded(size, 0);
+
+    for (auto _ : state) {
+        file.Rewind();
+        Buffer buffer {file.Fd()};
+        std::istream in(&buffer);
+
+        in.read(decoded.data(), decoded.size());
+        benchmark::DoNotOptimize(decoded.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * size);
+}
@@ -0,0 +1,21 @@
+// hex-in-stream-buffer.bench.cpp
+
+#include "bench-utils.hpp"
+#include "hex-in-stream-buffer.hpp"
+#include "hot-path.hpp"
+
+// Clones the underflow of HexInBuf for HOT_PATH.
+class HotHexInBuf : public HexInBuf {
+public:
+    using HexInBuf::HexInBuf;
+
+protected:
+    HOT_PATH virtual int_type underflow() override {
+        return HexInBuf::underflow();
+    }
+};
+
+static void BM_HexInBufBuffer(benchmark::State &state) {
+    ReadAll<HotHexInBuf>(state);
+}
+BENCHMARK(BM_HexInBufBuffer)->ArgName("size")->Arg(64)->Arg(4096);
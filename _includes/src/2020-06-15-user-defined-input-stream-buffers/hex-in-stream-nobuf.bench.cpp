@@ -0,0 +1,9 @@
+// hex-in-stream-nobuf.bench.cpp
+
+#include "bench-utils.hpp"
+#include "hex-in-stream-nobuf.hpp"
+
+static void BM_HexInBufNobuf(benchmark::State &state) {
+    ReadAll<HexInBuf>(state);
+}
+BENCHMARK(BM_HexInBufNobuf)->ArgName("size")->Arg(64)->Arg(4096);
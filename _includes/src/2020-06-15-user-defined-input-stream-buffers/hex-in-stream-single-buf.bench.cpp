@@ -0,0 +1,9 @@
+// hex-in-stream-single-buf.bench.cpp
+
+#include "bench-utils.hpp"
+#include "hex-in-stream-single-buf.hpp"
+
+static void BM_HexInBufSingleBuf(benchmark::State &state) {
+    ReadAll<HexInBuf>(state);
+}
+BENCHMARK(BM_HexInBufSingleBuf)->ArgName("size")->Arg(64)->Arg(4096);
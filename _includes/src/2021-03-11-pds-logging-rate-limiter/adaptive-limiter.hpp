@@ -0,0 +1,85 @@
+// adaptive-limiter.hpp
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "hot-path.hpp"
+#include "rate.hpp"
+
+struct AimdSettings {
+    long min_rate = 1;
+    long max_rate = 100;
+    long increase = 1;
+    double decrease = 0.5;
+    std::chrono::nanoseconds latency_target = 1ms;
+    std::chrono::nanoseconds period = 100ms;
+};
+
+// Additive increase, multiplicative decrease: the rate starts at max_rate, grows by
+// `increase` after every period without congestion, and is scaled by `decrease` at most once
+// per period when the sink fails or takes longer than the latency target. The burst allowed
+// is one period's worth of permits.
+template<typename Clock = std::chrono::steady_clock>
+class AdaptiveLimiter {
+public:
+    explicit AdaptiveLimiter(const AimdSettings &settings = {}) :
+        m_settings(settings), m_rate(settings.max_rate), m_tokens(burst()) {
+    }
+
+    HOT_PATH bool FetchToken() {
+        fill(Clock::now());
+
+        if (m_tokens >= 1) {
+            m_tokens -= 1;
+            return true;
+        }
+
+        return false;
+    }
+
+    void Feedback(const bool succeeded, const typename Clock::time_point &started) {
+        const auto now = Clock::now();
+        if (not succeeded or now - started > m_settings.latency_target) {
+            if (now >= m_next_decrease) {
+                setRate(static_cast<long>(m_rate * m_settings.decrease));
+                m_next_decrease = now + m_settings.period;
+            }
+            m_next_increase = now + m_settings.period;
+        } else if (now >= m_next_increase) {
+            setRate(m_rate + m_settings.increase);
+            m_next_increase = now + m_settings.period;
+        }
+    }
+
+    long EffectiveRate() const {
+        return m_effective_rate.load(std::memory_order_relaxed);
+    }
+
+private:
+    double burst() const {
+        return std::max(1.0, m_rate * std::chrono::duration<double>(m_settings.period).count());
+    }
+
+    void fill(const typename Clock::time_point &now) {
+        const std::chrono::duration<double> elapsed = now - m_last_time;
+        m_last_time = now;
+        m_tokens = std::min(burst(), m_tokens + elapsed.count() * m_rate);
+    }
+
+    void setRate(const long rate) {
+        m_rate = std::clamp(rate, m_settings.min_rate, m_settings.max_rate);
+        m_tokens = std::min(burst(), m_tokens);
+        m_effective_rate.store(m_rate, std::memory_order_relaxed);
+    }
+
+    const AimdSettings m_settings;
+    long m_rate = 0;
+    double m_tokens = 0;
+    typename Clock::time_point m_last_time = Clock::now();
+    typename Clock::time_point m_next_increase = m_last_time + m_settings.period;
+    typename Clock::time_point m_next_decrease = m_last_time;
+    std::atomic<long> m_effective_rate {m_rate};
+};
@@ -0,0 +1,146 @@
+// adaptive-limiter.test.cpp
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "adaptive-logger.hpp"
+#include "clocks.hpp"
+
+
+static constexpr AimdSettings SETTINGS {
+    .min_rate = 10,
+    .max_rate = 1'000,
+    .increase = 10,
+    .decrease = 0.5,
+    .latency_target = 1ms,
+    .period = 100ms,
+};
+
+TEST(AdaptiveLimiterTests, TestDecreasesOncePerPeriod) {
+    ManualClock::Reset(1s);
+    AdaptiveLimiter<ManualClock> limiter {SETTINGS};
+    EXPECT_EQ(1'000, limiter.EffectiveRate());
+
+    limiter.Feedback(false, ManualClock::now());
+    EXPECT_EQ(500, limiter.EffectiveRate());
+    limiter.Feedback(false, ManualClock::now());
+    EXPECT_EQ(500, limiter.EffectiveRate());
+
+    ManualClock::Advance(SETTINGS.period);
+    limiter.Feedback(true, ManualClock::now() - 2 * SETTINGS.latency_target);
+    EXPECT_EQ(250, limiter.EffectiveRate());
+
+    for (auto i = 0; i < 10; ++i) {
+        ManualClock::Advance(SETTINGS.period);
+        limiter.Feedback(false, ManualClock::now());
+    }
+    EXPECT_EQ(SETTINGS.min_rate, limiter.EffectiveRate());
+}
+
+TEST(AdaptiveLimiterTests, TestIncreasesAfterQuietPeriods) {
+    ManualClock::Reset(1s);
+    AdaptiveLimiter<ManualClock> limiter {SETTINGS};
+    limiter.Feedback(false, ManualClock::now());
+
+    limiter.Feedback(true, ManualClock::now());
+    EXPECT_EQ(500, limiter.EffectiveRate());
+    for (auto i = 1; i <= 10; ++i) {
+        ManualClock::Advance(SETTINGS.period);
+        limiter.Feedback(true, ManualClock::now());
+        EXPECT_EQ(500 + i * SETTINGS.increase, limiter.EffectiveRate());
+    }
+
+    for (auto i = 0; i < 100; ++i) {
+        ManualClock::Advance(SETTINGS.period);
+        limiter.Feedback(true, ManualClock::now());
+    }
+    EXPECT_EQ(SETTINGS.max_rate, limiter.EffectiveRate());
+}
+
+TEST(AdaptiveLimiterTests, TestBurstIsOnePeriod) {
+    ManualClock::Reset(1s);
+    AdaptiveLimiter<ManualClock> limiter {SETTINGS};
+
+    long granted = 0;
+    while (limiter.FetchToken()) {
+        ++granted;
+    }
+    EXPECT_EQ(100, granted);
+
+    ManualClock::Advance(10ms);
+    EXPECT_TRUE(limiter.FetchToken());
+}
+
+// Writes to the pipe set by the test, since loggers default-construct their sinks.
+class PipeSink {
+public:
+    static void SetFd(const int fd) {
+        m_fd = fd;
+    }
+
+    bool Log(const Logpp::Level, const std::string_view message) {
+        m_line.assign(message).push_back('\n');
+        return write(m_fd, m_line.data(), m_line.size()) == static_cast<ssize_t>(m_line.size());
+    }
+
+private:
+    static inline int m_fd = -1;
+    std::string m_line;
+};
+
+TEST(AdaptiveLimiterTests, TestTracksThrottledPipeReader) {
+    constexpr long READER_RATE = 5'000;
+    constexpr std::size_t LINE_SIZE = 64;
+    constexpr auto READ_PERIOD = 1ms;
+    constexpr auto DURATION = 2s;
+
+    int fds[2] = {};
+    ASSERT_EQ(0, pipe2(fds, O_NONBLOCK));
+    fcntl(fds[1], F_SETPIPE_SZ, 4096);
+
+    std::atomic<bool> done {false};
+    std::thread reader {[&done, fd = fds[0], READER_RATE, READ_PERIOD] {
+        std::string buffer(READER_RATE * LINE_SIZE * READ_PERIOD / 1s, 0);
+        for (auto next = std::chrono::steady_clock::now(); not done; next += READ_PERIOD) {
+            std::this_thread::sleep_until(next);
+            [[maybe_unused]] const auto ignored = read(fd, buffer.data(), buffer.size());
+        }
+    }};
+
+    PipeSink::SetFd(fds[1]);
+    AdaptiveLogger<std::chrono::steady_clock, PipeSink> logger {AimdSettings {
+        .min_rate = 100,
+        .max_rate = 100'000,
+        .increase = READER_RATE / 20,
+        .decrease = 0.5,
+        .latency_target = 1ms,
+        .period = 10ms,
+    }};
+    const std::string message(LINE_SIZE - 1, 'x');
+
+    double rate_sum = 0;
+    long samples = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto now = start; now - start < DURATION; now = std::chrono::steady_clock::now()) {
+        logger.Info(message);
+        if (now - start > DURATION / 2) {
+            rate_sum += logger.EffectiveRate();
+            ++samples;
+        }
+    }
+
+    done = true;
+    reader.join();
+    close(fds[0]);
+    close(fds[1]);
+
+    const auto mean_rate = rate_sum / samples;
+    EXPECT_GT(mean_rate, 0.4 * READER_RATE);
+    EXPECT_LT(mean_rate, 1.5 * READER_RATE);
+}
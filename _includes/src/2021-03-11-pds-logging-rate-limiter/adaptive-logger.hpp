@@ -0,0 +1,51 @@
+// adaptive-logger.hpp
+
+#pragma once
+
+#include "adaptive-limiter.hpp"
+#include "format-logging.hpp"
+#include "logpp.hpp"
+
+template<typename Clock = std::chrono::steady_clock, typename Sink = Logpp>
+class AdaptiveLogger : public FormatLogging<AdaptiveLogger<Clock, Sink>> {
+public:
+    using FormatLogging<AdaptiveLogger>::Info;
+    using FormatLogging<AdaptiveLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
+    }
+
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
+    }
+
+    explicit AdaptiveLogger(const AimdSettings &settings = {}) : m_limiter(settings) {
+    }
+
+    long EffectiveRate() const {
+        return m_limiter.EffectiveRate();
+    }
+
+private:
+    friend FormatLogging<AdaptiveLogger>;
+
+    template<typename Message>
+    bool log(const Logpp::Level a_level, const Message &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        if (not m_limiter.FetchToken()) {
+            return false;
+        }
+
+        const auto started = Clock::now();
+        const auto logged = m_logger.Log(a_level, MessageOf(message));
+        m_limiter.Feedback(logged, started);
+        return logged;
+    }
+
+    AdaptiveLimiter<Clock> m_limiter;
+    Sink m_logger;
+};
@@ -0,0 +1,6 @@
+#include "adaptive-logger.hpp"
+#include "test-utils.hpp"
+
+int main() {
+    TestLimiterLogger(AdaptiveLogger {AimdSettings {.min_rate = 1, .max_rate = 3}});
+}
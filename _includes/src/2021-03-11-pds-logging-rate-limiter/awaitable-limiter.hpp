@@ -0,0 +1,91 @@
+// awaitable-limiter.hpp
+
+#pragma once
+
+#include <coroutine>
+#include <memory>
+#include <optional>
+#include <semaphore>
+
+#include "gcra.hpp"
+#include "timer-wheel.hpp"
+
+// Callers wait for their permit instead of being rejected. Permits are reserved in FIFO
+// order, each one interval after the previous, and waiters are woken by a timer wheel. A
+// suspended coroutine resumes on the wheel's thread, TimerWheel::Shared() by default, so it
+// should hand long work off rather than hold up every other timer on that wheel.
+class AwaitableLimiter {
+public:
+    using Clock = TimerWheel::Clock;
+
+    class Awaiter {
+    public:
+        explicit Awaiter(AwaitableLimiter &limiter) : m_limiter(limiter) {
+        }
+
+        bool await_ready() {
+            m_ready = m_limiter.reserve(Clock::time_point::max());
+            return not m_ready or *m_ready <= Clock::now();
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle) {
+            m_limiter.m_wheel.Schedule(*m_ready, [handle] {
+                handle.resume();
+            });
+        }
+
+        // Whether the permit was granted.
+        bool await_resume() const {
+            return m_ready.has_value();
+        }
+
+    private:
+        AwaitableLimiter &m_limiter;
+        std::optional<Clock::time_point> m_ready;
+    };
+
+    explicit AwaitableLimiter(const Rate &rate, TimerWheel &wheel = TimerWheel::Shared()) :
+        m_policy(rate), m_wheel(wheel) {
+    }
+
+    AwaitableLimiter(const Rate &rate,
+                     const long capacity,
+                     TimerWheel &wheel = TimerWheel::Shared()) :
+        m_policy(rate, capacity), m_wheel(wheel) {
+    }
+
+    auto Acquire() {
+        return Awaiter {*this};
+    }
+
+    bool Acquire(const Clock::time_point deadline) {
+        const auto ready = reserve(deadline);
+        if (not ready) {
+            return false;
+        }
+
+        if (*ready > Clock::now()) {
+            // Shared with the timer, as release() may still touch it after acquire() returns.
+            const auto woken = std::make_shared<std::binary_semaphore>(0);
+            m_wheel.Schedule(*ready, [woken] {
+                woken->release();
+            });
+            woken->acquire();
+        }
+        return true;
+    }
+
+private:
+    std::optional<Clock::time_point> reserve(const Clock::time_point deadline) {
+        const auto ready = m_policy.Reserve(m_tat, NanosecondsOf<Clock>(Clock::now()),
+                                            NanosecondsOf<Clock>(deadline));
+        if (not ready) {
+            return std::nullopt;
+        }
+        return Clock::time_point {std::chrono::nanoseconds(*ready)};
+    }
+
+    GcraPolicy<> m_policy;
+    GcraPolicy<>::State m_tat {0};
+    TimerWheel &m_wheel;
+};
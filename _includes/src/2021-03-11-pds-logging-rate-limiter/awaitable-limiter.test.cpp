@@ -0,0 +1,95 @@
+// awaitable-limiter.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <latch>
+#include <string>
+#include <vector>
+
+#include "awaitable-limiter.hpp"
+
+using Clock = AwaitableLimiter::Clock;
+
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+Detached WaitForPermit(AwaitableLimiter &limiter,
+                       Clock::time_point &wakeup,
+                       std::size_t &position,
+                       std::atomic<std::size_t> &next_position,
+                       std::latch &done) {
+    const auto granted = co_await limiter.Acquire();
+    wakeup = Clock::now();
+    EXPECT_TRUE(granted);
+    position = next_position++;
+    done.count_down();
+}
+
+
+TEST(AwaitableLimiterTests, TestBlockingAcquireHonorsDeadline) {
+    TimerWheel wheel;
+    AwaitableLimiter limiter {Rate {10}, 1, wheel};
+
+    const auto start = Clock::now();
+    EXPECT_TRUE(limiter.Acquire(start + 1s));
+    EXPECT_FALSE(limiter.Acquire(start + 10ms));
+    EXPECT_TRUE(limiter.Acquire(start + 1s));
+    EXPECT_GE(Clock::now() - start, 100ms);
+}
+
+TEST(AwaitableLimiterTests, TestWakeupsFollowScheduleInFifoOrder) {
+    constexpr std::size_t WAITER_COUNT = 2000;
+    constexpr long RATE = 20'000;
+    constexpr auto INTERVAL = std::chrono::nanoseconds(1s) / RATE;
+
+    TimerWheel wheel;
+    AwaitableLimiter limiter {Rate {RATE}, 1, wheel};
+    std::vector<Clock::time_point> wakeups(WAITER_COUNT);
+    std::vector<std::size_t> positions(WAITER_COUNT);
+    std::atomic<std::size_t> next_position {0};
+    std::latch done {WAITER_COUNT};
+
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < WAITER_COUNT; ++i) {
+        WaitForPermit(limiter, wakeups[i], positions[i], next_position, done);
+    }
+    done.wait();
+
+    std::vector<Clock::duration> deviations;
+    for (std::size_t i = 0; i < WAITER_COUNT; ++i) {
+        EXPECT_EQ(i, positions[i]);
+        const auto deviation = wakeups[i] - (start + i * INTERVAL);
+        EXPECT_GE(deviation, 0ns);
+        deviations.push_back(deviation);
+    }
+
+    std::sort(deviations.begin(), deviations.end());
+    const auto median = deviations[deviations.size() / 2];
+    const auto p99 = deviations[deviations.size() * 99 / 100];
+    const auto microseconds = [](const auto duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    };
+    RecordProperty("WakeupDeviationMedianUs", std::to_string(microseconds(median)));
+    RecordProperty("WakeupDeviationP99Us", std::to_string(microseconds(p99)));
+    RecordProperty("WakeupDeviationMaxUs", std::to_string(microseconds(deviations.back())));
+    EXPECT_LT(median, 1ms);
+}
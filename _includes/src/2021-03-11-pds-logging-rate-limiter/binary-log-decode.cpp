@@ -0,0 +1,20 @@
+// binary-log-decode.cpp
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "binary-log.hpp"
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary-log-file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in {argv[1], std::ios::binary};
+    if (not BinaryLogDecoder::Decode(in, std::cout)) {
+        std::cerr << "Malformed binary log: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+}
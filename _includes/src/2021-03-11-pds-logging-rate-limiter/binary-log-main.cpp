@@ -0,0 +1,16 @@
+#include <iostream>
+#include <sstream>
+
+#include "binary-log.hpp"
+#include "test-utils.hpp"
+#include "token-bucket-logger.hpp"
+
+int main() {
+    std::stringstream binary_log;
+    {
+        const BinaryLogWriter writer {binary_log};
+        TestLimiterLogger(TokenBucketLogger<std::chrono::steady_clock, BinaryLogpp> {3});
+    }
+
+    return BinaryLogDecoder::Decode(binary_log, std::cout) ? 0 : 1;
+}
@@ -0,0 +1,495 @@
+// binary-log.hpp
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "log-format.hpp"
+#include "logpp.hpp"
+
+// NanoLog style logging: a statement copies its site ID, a raw timestamp and its raw arguments
+// into a ring owned by its thread, a writer thread ships the rings byte for byte, and all
+// formatting is left to the decoder, which formats exactly as FormatLog() would.
+
+template<typename T>
+constexpr char BinaryArgType() {
+    static_assert(IS_LOG_ARGUMENT<T>, "Unsupported binary log argument");
+    if constexpr (std::is_same_v<T, bool>) {
+        return 'b';
+    } else if constexpr (std::is_same_v<T, char>) {
+        return 'c';
+    } else if constexpr (std::is_integral_v<T> and std::is_signed_v<T>) {
+        return 'i';
+    } else if constexpr (std::is_integral_v<T>) {
+        return 'u';
+    } else if constexpr (std::is_same_v<T, float>) {
+        return 'f';
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return 'd';
+    } else {
+        return 's';
+    }
+}
+
+template<typename... Args>
+inline constexpr char BINARY_ARG_TYPES[] = {BinaryArgType<Args>()..., '\0'};
+
+template<typename... Args>
+constexpr std::string_view BinaryArgTypes() {
+    return {BINARY_ARG_TYPES<Args...>, sizeof...(Args)};
+}
+
+class BinaryLogSite;
+
+class BinaryLogBuffer {
+public:
+    static constexpr std::size_t CAPACITY = std::size_t {1} << 20;
+
+    BinaryLogBuffer() : m_data(std::make_unique<char[]>(CAPACITY)) {
+    }
+
+    static BinaryLogBuffer &Local();
+
+    // Returns where a record of size bytes starts, unless the ring is too full for it.
+    std::optional<std::size_t> Reserve(const std::size_t size) const {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) + size > CAPACITY) {
+            return std::nullopt;
+        }
+        return head;
+    }
+
+    void PutBytes(std::size_t &position, const void *data, const std::size_t size) {
+        const auto offset = position & MASK;
+        const auto first = std::min(size, CAPACITY - offset);
+        std::memcpy(m_data.get() + offset, data, first);
+        std::memcpy(m_data.get(), static_cast<const char *>(data) + first, size - first);
+        position += size;
+    }
+
+    template<typename T>
+    void Put(std::size_t &position, const T value) {
+        PutBytes(position, &value, sizeof(value));
+    }
+
+    void Commit(const std::size_t position) {
+        m_head.store(position, std::memory_order_release);
+    }
+
+    std::size_t Head() const {
+        return m_head.load(std::memory_order_acquire);
+    }
+
+    // Everything committed up to head, in at most two pieces.
+    std::array<std::string_view, 2> Pending(const std::size_t head) const {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto offset = tail & MASK;
+        const auto first = std::min(head - tail, CAPACITY - offset);
+        return {std::string_view {m_data.get() + offset, first},
+                std::string_view {m_data.get(), head - tail - first}};
+    }
+
+    void Release(const std::size_t head) {
+        m_tail.store(head, std::memory_order_release);
+    }
+
+    bool Empty() const {
+        return Head() == m_tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::size_t MASK = CAPACITY - 1;
+
+    std::unique_ptr<char[]> m_data;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head {0};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail {0};
+};
+
+class BinaryLogRegistry {
+public:
+    static auto &Instance() {
+        static BinaryLogRegistry registry;
+        return registry;
+    }
+
+    std::uint32_t AddSite(const BinaryLogSite &site) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        m_sites.push_back(&site);
+        return m_sites.size() - 1;
+    }
+
+    auto SitesFrom(const std::size_t first) const {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        return std::vector<const BinaryLogSite *>(m_sites.begin() + first, m_sites.end());
+    }
+
+    auto AddBuffer() {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        return m_buffers.emplace_back(std::make_shared<BinaryLogBuffer>());
+    }
+
+    auto Buffers() const {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        return m_buffers;
+    }
+
+    // Drops the drained buffers of threads that have exited.
+    void Prune() {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        std::erase_if(m_buffers, [](const auto &a_buffer) {
+            return a_buffer.use_count() == 1 and a_buffer->Empty();
+        });
+    }
+
+private:
+    BinaryLogRegistry() = default;
+
+    mutable std::mutex m_mutex;
+    std::vector<const BinaryLogSite *> m_sites;
+    std::vector<std::shared_ptr<BinaryLogBuffer>> m_buffers;
+};
+
+inline BinaryLogBuffer &BinaryLogBuffer::Local() {
+    thread_local const auto buffer = BinaryLogRegistry::Instance().AddBuffer();
+    return *buffer;
+}
+
+class BinaryLogSite {
+public:
+    template<typename... Args>
+    explicit BinaryLogSite(const LogFormat<Args...> format) :
+        m_format(format.Format()), m_arg_types(BinaryArgTypes<Args...>()),
+        m_id(BinaryLogRegistry::Instance().AddSite(*this)) {
+    }
+
+    BinaryLogSite(const BinaryLogSite &) = delete;
+    BinaryLogSite &operator=(const BinaryLogSite &) = delete;
+
+    auto Format() const {
+        return m_format;
+    }
+
+    auto ArgTypes() const {
+        return m_arg_types;
+    }
+
+    auto Id() const {
+        return m_id;
+    }
+
+private:
+    std::string_view m_format;
+    std::string_view m_arg_types;
+    std::uint32_t m_id = 0;
+};
+
+// A drop-in sink for the limiter loggers: Log() fails only when the ring of the calling
+// thread is full, and the message is copied as the only argument of a "{}" site.
+class BinaryLogpp {
+public:
+    auto Log(const Logpp::Level a_level, const std::string_view message) const {
+        static const BinaryLogSite site {LogFormat<std::string_view> {"{}"}};
+        return Log(site, a_level, message);
+    }
+
+    template<typename... Args>
+    bool Log(const BinaryLogSite &site, const Logpp::Level a_level, const Args &...args) const {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        const std::int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                           std::chrono::system_clock::now().time_since_epoch())
+                                           .count();
+
+        auto &buffer = BinaryLogBuffer::Local();
+        auto position = buffer.Reserve(sizeof(std::uint32_t) + sizeof(char) + sizeof(timestamp) +
+                                       (sizeOf(args) + ... + 0));
+        if (not position) {
+            return false;
+        }
+
+        buffer.Put(*position, site.Id());
+        buffer.Put(*position, static_cast<char>(a_level));
+        buffer.Put(*position, timestamp);
+        (put(buffer, *position, args), ...);
+        buffer.Commit(*position);
+        return true;
+    }
+
+private:
+    template<typename T>
+    static std::size_t sizeOf(const T &value) {
+        constexpr auto type = BinaryArgType<T>();
+        if constexpr (type == 's') {
+            return sizeof(std::uint32_t) + std::string_view {value}.size();
+        } else if constexpr (type == 'b' or type == 'c') {
+            return sizeof(char);
+        } else {
+            return sizeof(std::uint64_t);
+        }
+    }
+
+    template<typename T>
+    static void put(BinaryLogBuffer &buffer, std::size_t &position, const T &value) {
+        constexpr auto type = BinaryArgType<T>();
+        if constexpr (type == 's') {
+            const std::string_view str {value};
+            buffer.Put(position, static_cast<std::uint32_t>(str.size()));
+            buffer.PutBytes(position, str.data(), str.size());
+        } else if constexpr (type == 'b' or type == 'c') {
+            buffer.Put(position, value);
+        } else if constexpr (type == 'i') {
+            buffer.Put(position, static_cast<std::int64_t>(value));
+        } else if constexpr (type == 'u') {
+            buffer.Put(position, static_cast<std::uint64_t>(value));
+        } else {
+            buffer.Put(position, static_cast<double>(value));
+        }
+    }
+};
+
+// The format must be a literal, and is checked at compile time against the arguments.
+#define BINARY_LOG(logger, level, format, ...)                                             \
+    [&](const auto &...args) {                                                             \
+        static const BinaryLogSite site {                                                  \
+            LogFormat<std::decay_t<decltype(args)>...> {format}};                          \
+        return (logger).Log(site, level, args...);                                         \
+    }(__VA_ARGS__)
+
+// Ships new sites and then the pending bytes of every ring, so a record always follows the
+// definition of its site.
+class BinaryLogWriter {
+public:
+    static constexpr std::string_view MAGIC = "BINLOG1\n";
+    static constexpr char SITE_TAG = 'S';
+    static constexpr char CHUNK_TAG = 'C';
+    static constexpr std::chrono::milliseconds DEFAULT_PERIOD {1};
+
+    explicit BinaryLogWriter(std::ostream &out,
+                             const std::chrono::milliseconds period = DEFAULT_PERIOD) :
+        m_out(out), m_period(period) {
+        m_out.write(MAGIC.data(), MAGIC.size());
+        m_thread = std::thread {[this] {
+            run();
+        }};
+    }
+
+    BinaryLogWriter(const BinaryLogWriter &) = delete;
+    BinaryLogWriter &operator=(const BinaryLogWriter &) = delete;
+
+    ~BinaryLogWriter() {
+        {
+            std::lock_guard<std::mutex> guard {m_stop_mutex};
+            m_stop = true;
+        }
+        m_stop_cv.notify_one();
+        m_thread.join();
+        Flush();
+    }
+
+    void Flush() {
+        std::lock_guard<std::mutex> guard {m_flush_mutex};
+        auto &registry = BinaryLogRegistry::Instance();
+
+        const auto buffers = registry.Buffers();
+        std::vector<std::size_t> heads;
+        for (const auto &a_buffer : buffers) {
+            heads.push_back(a_buffer->Head());
+        }
+
+        for (const auto *a_site : registry.SitesFrom(m_sites_written)) {
+            writeSite(*a_site);
+            ++m_sites_written;
+        }
+
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            const auto pieces = buffers[i]->Pending(heads[i]);
+            const auto size = pieces[0].size() + pieces[1].size();
+            if (size) {
+                m_out.put(CHUNK_TAG);
+                writeRaw(static_cast<std::uint32_t>(size));
+                for (const auto a_piece : pieces) {
+                    m_out.write(a_piece.data(), a_piece.size());
+                }
+                buffers[i]->Release(heads[i]);
+            }
+        }
+        m_out.flush();
+    }
+
+private:
+    template<typename T>
+    void writeRaw(const T value) {
+        m_out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void writeString(const std::string_view str) {
+        writeRaw(static_cast<std::uint32_t>(str.size()));
+        m_out.write(str.data(), str.size());
+    }
+
+    void writeSite(const BinaryLogSite &site) {
+        m_out.put(SITE_TAG);
+        writeRaw(site.Id());
+        writeString(site.ArgTypes());
+        writeString(site.Format());
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock {m_stop_mutex};
+        while (not m_stop_cv.wait_for(lock, m_period, [this] {
+            return m_stop;
+        })) {
+            lock.unlock();
+            Flush();
+            BinaryLogRegistry::Instance().Prune();
+            lock.lock();
+        }
+    }
+
+    std::ostream &m_out;
+    const std::chrono::milliseconds m_period;
+
+    std::mutex m_flush_mutex;
+    std::size_t m_sites_written = 0;
+
+    std::mutex m_stop_mutex;
+    std::condition_variable m_stop_cv;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+class BinaryLogDecoder {
+public:
+    // Writes every record in the text format of Logpp, and fails on a malformed log. The rings
+    // of the threads are shipped one after another, so the records are held to the end and
+    // written in time order.
+    static bool Decode(std::istream &in, std::ostream &out) {
+        std::string magic(BinaryLogWriter::MAGIC.size(), 0);
+        in.read(magic.data(), magic.size());
+        if (not in or magic != BinaryLogWriter::MAGIC) {
+            return false;
+        }
+
+        Sites sites;
+        Records records;
+        for (char tag; in.get(tag);) {
+            if (tag == BinaryLogWriter::SITE_TAG) {
+                const auto id = readRaw<std::uint32_t>(in);
+                auto arg_types = readString(in);
+                sites[id] = {std::move(arg_types), readString(in)};
+            } else if (tag == BinaryLogWriter::CHUNK_TAG) {
+                std::istringstream chunk {readString(in)};
+                while (chunk.peek() != std::istringstream::traits_type::eof()) {
+                    if (not decodeRecord(chunk, sites, records)) {
+                        return false;
+                    }
+                }
+            } else {
+                return false;
+            }
+
+            if (not in) {
+                return false;
+            }
+        }
+
+        std::stable_sort(records.begin(), records.end(), [](const auto &a, const auto &b) {
+            return a.first < b.first;
+        });
+        for (const auto &[timestamp, a_line] : records) {
+            out << a_line;
+        }
+        return true;
+    }
+
+private:
+    // The argument types and the format of every site, by ID.
+    using Sites = std::map<std::uint32_t, std::pair<std::string, std::string>>;
+    // The lines decoded so far, with their timestamps.
+    using Records = std::vector<std::pair<std::chrono::nanoseconds, std::string>>;
+
+    template<typename T>
+    static T readRaw(std::istream &in) {
+        T value {};
+        in.read(reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    }
+
+    static std::string readString(std::istream &in) {
+        std::string str(readRaw<std::uint32_t>(in), 0);
+        in.read(str.data(), str.size());
+        return str;
+    }
+
+    static void decodeArg(std::istream &in, const char type, std::string &out) {
+        switch (type) {
+        case 'b':
+            AppendLogArg(out, readRaw<char>(in) != 0);
+            break;
+        case 'c':
+            AppendLogArg(out, readRaw<char>(in));
+            break;
+        case 'i':
+            AppendLogArg(out, readRaw<std::int64_t>(in));
+            break;
+        case 'u':
+            AppendLogArg(out, readRaw<std::uint64_t>(in));
+            break;
+        case 'f':
+            AppendLogArg(out, static_cast<float>(readRaw<double>(in)));
+            break;
+        case 'd':
+            AppendLogArg(out, readRaw<double>(in));
+            break;
+        default:
+            AppendLogArg(out, readString(in));
+        }
+    }
+
+    static bool decodeRecord(std::istream &in, const Sites &sites, Records &records) {
+        const auto id = readRaw<std::uint32_t>(in);
+        const auto a_level = static_cast<Logpp::Level>(readRaw<char>(in));
+        const std::chrono::nanoseconds timestamp {readRaw<std::int64_t>(in)};
+        const auto site = sites.find(id);
+        if (not in or site == sites.cend()) {
+            return false;
+        }
+
+        const auto &[arg_types, format] = site->second;
+        std::string message;
+        std::size_t position = 0;
+        for (const auto type : arg_types) {
+            position = AppendLogLiteral(message, format, position) + 2;
+            decodeArg(in, type, message);
+        }
+        AppendLogLiteral(message, format, position);
+
+        const std::chrono::system_clock::time_point tp {
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(timestamp)};
+        std::ostringstream line;
+        Logpp::Format(line, tp, a_level, message) << '\n';
+        records.emplace_back(timestamp, line.str());
+        return static_cast<bool>(in);
+    }
+};
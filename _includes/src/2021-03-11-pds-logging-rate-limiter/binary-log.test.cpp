@@ -0,0 +1,139 @@
+// binary-log.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binary-log.hpp"
+#include "gcra-logger.hpp"
+
+
+static auto decode(std::stringstream &binary_log) {
+    std::ostringstream text;
+    EXPECT_TRUE(BinaryLogDecoder::Decode(binary_log, text));
+    return text.str();
+}
+
+static auto textOf(const std::chrono::system_clock::time_point &tp,
+                   const Logpp::Level a_level,
+                   const std::string_view message) {
+    std::ostringstream text;
+    Logpp::Format(text, tp, a_level, message) << '\n';
+    return text.str();
+}
+
+TEST(BinaryLogTests, TestDecodesToTextFormat) {
+    std::stringstream binary_log;
+    std::chrono::system_clock::time_point before;
+    std::chrono::system_clock::time_point after;
+    do {
+        binary_log.str({});
+        const BinaryLogWriter writer {binary_log};
+        const BinaryLogpp logger;
+
+        before = std::chrono::system_clock::now();
+        EXPECT_TRUE(logger.Log(Logpp::Level::info, "plain message"));
+        EXPECT_TRUE((BINARY_LOG(logger, Logpp::Level::error, "{} of {} failed: {} ({})", -3, 7U,
+                                std::string {"timeout"}, 'x')));
+        EXPECT_TRUE((BINARY_LOG(logger, Logpp::Level::warning, "{{ratio}} {} {} {}", 0.1, 0.1F,
+                                true)));
+        after = std::chrono::system_clock::now();
+    } while (std::chrono::floor<std::chrono::seconds>(before) !=
+             std::chrono::floor<std::chrono::seconds>(after));
+
+    EXPECT_EQ(textOf(before, Logpp::Level::info, "plain message") +
+                  textOf(before, Logpp::Level::error, "-3 of 7 failed: timeout (x)") +
+                  textOf(before, Logpp::Level::warning,
+                         FormatLog("{{ratio}} {} {} {}", 0.1, 0.1F, true)),
+              decode(binary_log));
+}
+
+TEST(BinaryLogTests, TestLimiterLoggerWritesAdmittedMessages) {
+    std::stringstream binary_log;
+    {
+        const BinaryLogWriter writer {binary_log};
+        GcraLogger<std::chrono::steady_clock, BinaryLogpp> logger {2};
+        for (auto i = 0; i < 10; ++i) {
+            logger.Info("limited");
+        }
+    }
+
+    std::istringstream text {decode(binary_log)};
+    long lines = 0;
+    for (std::string line; std::getline(text, line); ++lines) {
+        EXPECT_NE(std::string::npos, line.find("(I) limited"));
+    }
+    EXPECT_EQ(2, lines);
+}
+
+TEST(BinaryLogTests, TestKeepsRecordsOfExitedThreads) {
+    constexpr auto THREAD_COUNT = 8;
+    constexpr auto RECORD_COUNT = 1'000;
+
+    std::stringstream binary_log;
+    {
+        const BinaryLogWriter writer {binary_log};
+        std::vector<std::thread> threads;
+        for (auto i = 0; i < THREAD_COUNT; ++i) {
+            threads.emplace_back([i] {
+                const BinaryLogpp logger;
+                for (auto j = 0; j < RECORD_COUNT; ++j) {
+                    BINARY_LOG(logger, Logpp::Level::debug, "thread {} record {}", i, j);
+                }
+            });
+        }
+        for (auto &a_thread : threads) {
+            a_thread.join();
+        }
+    }
+
+    std::istringstream text {decode(binary_log)};
+    long lines = 0;
+    for (std::string line; std::getline(text, line);) {
+        ++lines;
+    }
+    EXPECT_EQ(THREAD_COUNT * RECORD_COUNT, lines);
+}
+
+TEST(BinaryLogTests, TestMergesThreadsInTimeOrder) {
+    constexpr auto RECORD_COUNT = 1'000;
+
+    std::stringstream binary_log;
+    {
+        const BinaryLogWriter writer {binary_log, 1h};
+        std::atomic<int> next {0};
+        std::vector<std::thread> threads;
+        for (auto i = 0; i < 2; ++i) {
+            threads.emplace_back([i, &next] {
+                const BinaryLogpp logger;
+                for (auto j = i; j < RECORD_COUNT; j += 2) {
+                    while (next.load(std::memory_order_acquire) != j) {
+                        std::this_thread::yield();
+                    }
+                    BINARY_LOG(logger, Logpp::Level::info, "record {}", j);
+                    next.store(j + 1, std::memory_order_release);
+                }
+            });
+        }
+        for (auto &a_thread : threads) {
+            a_thread.join();
+        }
+    }
+
+    std::istringstream text {decode(binary_log)};
+    auto expected = 0;
+    for (std::string line; std::getline(text, line); ++expected) {
+        EXPECT_TRUE(line.ends_with("(I) record " + std::to_string(expected))) << line;
+    }
+    EXPECT_EQ(RECORD_COUNT, expected);
+}
+
+TEST(BinaryLogTests, TestRejectsMalformedLog) {
+    std::stringstream binary_log {"BINLOG1\nX"};
+    std::ostringstream text;
+    EXPECT_FALSE(BinaryLogDecoder::Decode(binary_log, text));
+}
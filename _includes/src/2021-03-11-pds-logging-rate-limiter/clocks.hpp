@@ -0,0 +1,122 @@
+// clocks.hpp
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/*
+ * Clock policies for the limiters. They all meet the std::chrono Clock requirements, so
+ * std::chrono::steady_clock, the default, is one of them.
+ */
+
+template<typename Clock>
+std::int64_t NanosecondsOf(const typename Clock::time_point time_point) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch())
+        .count();
+}
+
+// Reads the invariant TSC and scales it to steady_clock nanoseconds, calibrated once on the
+// first call. It falls back to steady_clock when the TSC is not invariant.
+class TscClock {
+public:
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<TscClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        static const Calibration calibration;
+        if (not calibration.ns_per_tick) {
+            return time_point {steadyNow()};
+        }
+
+        const auto ticks = static_cast<std::int64_t>(readTsc() - calibration.base_tsc);
+        return time_point {calibration.base_ns + duration(static_cast<rep>(
+                                                     ticks * calibration.ns_per_tick))};
+    }
+
+    static bool IsInvariant() {
+#if defined(__x86_64__) || defined(__i386__)
+        constexpr unsigned INVARIANT_TSC_BIT = 1U << 8;
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) and (edx & INVARIANT_TSC_BIT);
+#else
+        return false;
+#endif
+    }
+
+private:
+    struct Calibration {
+        Calibration() {
+            if (not IsInvariant()) {
+                return;
+            }
+
+            constexpr auto MIN_CALIBRATION = std::chrono::milliseconds(10);
+            const auto start_ns = steadyNow();
+            const auto start_tsc = readTsc();
+            auto end_ns = start_ns;
+            while (end_ns - start_ns < MIN_CALIBRATION) {
+                end_ns = steadyNow();
+            }
+            const auto end_tsc = readTsc();
+
+            ns_per_tick = double((end_ns - start_ns).count()) / (end_tsc - start_tsc);
+            base_ns = end_ns;
+            base_tsc = end_tsc;
+        }
+
+        double ns_per_tick = 0;
+        duration base_ns {0};
+        std::uint64_t base_tsc = 0;
+    };
+
+    static duration steadyNow() {
+        return std::chrono::duration_cast<duration>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    }
+
+    static std::uint64_t readTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+};
+
+// A virtual clock which only moves when told to, so tests can simulate hours in no time.
+class ManualClock {
+public:
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<ManualClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        return time_point {duration(nanoseconds().load(std::memory_order_relaxed))};
+    }
+
+    static void Advance(const duration elapsed) {
+        nanoseconds().fetch_add(elapsed.count(), std::memory_order_relaxed);
+    }
+
+    static void Reset(const duration since_epoch = duration {0}) {
+        nanoseconds().store(since_epoch.count(), std::memory_order_relaxed);
+    }
+
+private:
+    static std::atomic<rep> &nanoseconds() {
+        static std::atomic<rep> value {0};
+        return value;
+    }
+};
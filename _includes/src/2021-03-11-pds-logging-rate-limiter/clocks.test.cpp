@@ -0,0 +1,101 @@
+// clocks.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "clocks.hpp"
+#include "gcra.hpp"
+#include "multi-window-counter.hpp"
+#include "sharded-token-bucket.hpp"
+#include "token-bucket.hpp"
+
+using namespace std::chrono_literals;
+
+constexpr auto SIMULATED_DURATION = 3h;
+constexpr auto STEP = 10ms;
+constexpr long RATE = 10;
+
+template<typename Function>
+long CountGranted(Function &&fetch) {
+    long granted = 0;
+    for (auto elapsed = 0ms; elapsed < SIMULATED_DURATION; elapsed += STEP) {
+        granted += fetch() ? 1 : 0;
+        ManualClock::Advance(STEP);
+    }
+    return granted;
+}
+
+constexpr long ExpectedGranted(const long capacity) {
+    return capacity + RATE * std::chrono::seconds(SIMULATED_DURATION).count();
+}
+
+class SimulatedClockTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ManualClock::Reset();
+    }
+};
+
+
+TEST(ClockTests, TestTscClockFollowsSteadyClock) {
+    TscClock::now();
+
+    const auto steady_start = std::chrono::steady_clock::now();
+    const auto tsc_start = TscClock::now();
+    std::this_thread::sleep_for(20ms);
+    const auto tsc_elapsed = TscClock::now() - tsc_start;
+    const auto steady_elapsed = std::chrono::steady_clock::now() - steady_start;
+
+    EXPECT_GE(tsc_elapsed, 20ms);
+    EXPECT_NEAR(std::chrono::duration<double>(tsc_elapsed).count(),
+                std::chrono::duration<double>(steady_elapsed).count(), 0.002);
+}
+
+TEST_F(SimulatedClockTests, TestManualClock) {
+    EXPECT_EQ(0ns, ManualClock::now().time_since_epoch());
+    ManualClock::Advance(1h);
+    EXPECT_EQ(1h, ManualClock::now().time_since_epoch());
+}
+
+TEST_F(SimulatedClockTests, TestTokenBucketLimiter) {
+    TokenBucketLimiter<ManualClock> limiter {Rate {RATE}};
+
+    const auto granted = CountGranted([&limiter] {
+        return static_cast<bool>(limiter.FetchToken());
+    });
+    EXPECT_NEAR(ExpectedGranted(RATE), granted, RATE);
+}
+
+TEST_F(SimulatedClockTests, TestGcraLimiter) {
+    GcraLimiter<ManualClock> limiter {Rate {RATE}};
+
+    const auto granted = CountGranted([&limiter] {
+        return limiter.FetchToken();
+    });
+    EXPECT_NEAR(ExpectedGranted(RATE), granted, RATE);
+}
+
+TEST_F(SimulatedClockTests, TestShardedTokenBucketLimiter) {
+    ShardedTokenBucketLimiter<ManualClock> limiter {Rate {RATE}, RATE, 4};
+
+    const auto granted = CountGranted([&limiter] {
+        return limiter.FetchToken();
+    });
+    EXPECT_LE(granted, ExpectedGranted(RATE) + limiter.MaxOvershoot());
+    EXPECT_GE(granted, ExpectedGranted(0) - RATE);
+}
+
+TEST_F(SimulatedClockTests, TestMultiWindowCounter) {
+    constexpr long PER_MINUTE = 300;
+    BasicMultiWindowCounter<ManualClock, Tier<RATE, std::chrono::seconds>,
+                            Tier<PER_MINUTE, std::chrono::minutes>>
+        counter;
+
+    const auto granted = CountGranted([&counter] {
+        return counter.TryAcquire();
+    });
+    const auto minutes = std::chrono::minutes(SIMULATED_DURATION).count();
+    EXPECT_LE(granted, PER_MINUTE * (minutes + 1));
+    EXPECT_GE(granted, PER_MINUTE * minutes * 9 / 10);
+}
@@ -0,0 +1,73 @@
+// current-instance.hpp
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// The instance of T that the loggers write to, if any. A caller holds it through a Pin, and
+// Uninstall() returns only once no Pin can reach the instance, so its owner may destroy it
+// right after. A Pin counts itself into the slot of the current epoch, and Uninstall() flips
+// the epoch before it waits for the old slot to drain, twice, so new pins never keep it
+// waiting.
+template<typename T>
+class CurrentInstance {
+public:
+    class Pin {
+    public:
+        Pin(const Pin &) = delete;
+        Pin &operator=(const Pin &) = delete;
+
+        ~Pin() {
+            m_pins.fetch_sub(1, std::memory_order_release);
+        }
+
+        explicit operator bool() const {
+            return m_instance;
+        }
+
+        T *operator->() const {
+            return m_instance;
+        }
+
+    private:
+        friend class CurrentInstance;
+
+        Pin(std::atomic<long> &pins, T *instance) : m_pins(pins), m_instance(instance) {
+        }
+
+        std::atomic<long> &m_pins;
+        T *m_instance;
+    };
+
+    static Pin Acquire() {
+        auto &pins = m_pins[m_epoch.load() & 1];
+        pins.fetch_add(1);
+        return Pin {pins, m_instance.load()};
+    }
+
+    static void Install(T &instance) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        m_instance.store(&instance);
+    }
+
+    // Waits even when instance is no longer current, as a Pin may still hold it.
+    static void Uninstall(T &instance) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        auto *expected = &instance;
+        m_instance.compare_exchange_strong(expected, nullptr);
+        for (auto i = 0; i < 2; ++i) {
+            const auto epoch = m_epoch.fetch_add(1);
+            while (m_pins[epoch & 1].load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static inline std::mutex m_mutex;
+    static inline std::atomic<T *> m_instance {nullptr};
+    static inline std::atomic<unsigned> m_epoch {0};
+    static inline std::atomic<long> m_pins[2] {};
+};
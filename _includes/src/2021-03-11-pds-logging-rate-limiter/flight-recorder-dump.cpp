@@ -0,0 +1,31 @@
+// flight-recorder-dump.cpp
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "flight-recorder.hpp"
+#include "logpp.hpp"
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <flight-recorder-file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in {argv[1], std::ios::binary};
+    std::vector<FlightRecorder::Entry> entries;
+    if (not FlightRecorder::Read(in, entries)) {
+        std::cerr << "Malformed flight recorder: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (const auto &an_entry : entries) {
+        const std::chrono::system_clock::time_point tp {
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds {an_entry.nanoseconds})};
+        Logpp::Format(std::cout, tp, static_cast<Logpp::Level>(an_entry.level), an_entry.text)
+            << '\n';
+    }
+}
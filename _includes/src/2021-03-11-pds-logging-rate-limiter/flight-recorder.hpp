@@ -0,0 +1,161 @@
+// flight-recorder.hpp
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// The latest records, in a ring of fixed size slots mapped from a file, so they outlive a
+// crash of the process: the kernel still holds the pages. A slot is cleared, filled with a
+// memcpy and then published by a release store of its sequence number, without a syscall.
+// The ring of the previous run, crashed or not, is kept as PreviousPath(path).
+class FlightRecorder {
+public:
+    static constexpr std::string_view MAGIC = "FLIGHT1\n";
+    static constexpr std::size_t SLOT_SIZE = 256;
+    static constexpr std::size_t DEFAULT_SLOT_COUNT = 4096;
+
+    struct Header {
+        char magic[8];
+        std::uint64_t slot_count;
+        std::uint64_t next;
+    };
+
+    struct Slot {
+        std::uint64_t sequence;
+        std::int64_t nanoseconds;
+        std::uint16_t size;
+        char level;
+        char text[SLOT_SIZE - 19];
+    };
+    static_assert(sizeof(Slot) == SLOT_SIZE);
+
+    struct Entry {
+        std::uint64_t sequence;
+        std::int64_t nanoseconds;
+        char level;
+        std::string text;
+    };
+
+    explicit FlightRecorder(const std::filesystem::path &path,
+                            const std::size_t slot_count = DEFAULT_SLOT_COUNT) :
+        m_mask(std::bit_ceil(std::max<std::size_t>(slot_count, 1)) - 1),
+        m_size(sizeof(Header) + (m_mask + 1) * sizeof(Slot)) {
+        std::error_code ignored;
+        std::filesystem::rename(path, PreviousPath(path), ignored);
+        const auto fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), path.string());
+        }
+
+        auto *memory = ::ftruncate(fd, static_cast<off_t>(m_size)) == 0
+                           ? ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                           : MAP_FAILED;
+        const auto error = errno;
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            throw std::system_error(error, std::system_category(), path.string());
+        }
+
+        m_header = static_cast<Header *>(memory);
+        m_slots = reinterpret_cast<Slot *>(m_header + 1);
+        m_header->slot_count = m_mask + 1;
+        std::memcpy(m_header->magic, MAGIC.data(), MAGIC.size());
+    }
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    ~FlightRecorder() {
+        ::munmap(m_header, m_size);
+    }
+
+    static std::filesystem::path PreviousPath(const std::filesystem::path &path) {
+        return path.string() + ".previous";
+    }
+
+    // Makes a recorder the one RecordedSink writes to. It is never destroyed, as a record may
+    // still be on its way in during the exit.
+    static FlightRecorder &Install(const std::filesystem::path &path,
+                                   const std::size_t slot_count = DEFAULT_SLOT_COUNT) {
+        auto *recorder = new FlightRecorder {path, slot_count};
+        m_installed.store(recorder, std::memory_order_release);
+        return *recorder;
+    }
+
+    static FlightRecorder *Installed() {
+        return m_installed.load(std::memory_order_acquire);
+    }
+
+    void Record(const std::int64_t nanoseconds,
+                const char level,
+                const std::string_view message) noexcept {
+        const auto index =
+            std::atomic_ref {m_header->next}.fetch_add(1, std::memory_order_relaxed);
+        auto &a_slot = m_slots[index & m_mask];
+        std::atomic_ref sequence {a_slot.sequence};
+
+        sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        a_slot.nanoseconds = nanoseconds;
+        a_slot.level = level;
+        a_slot.size = static_cast<std::uint16_t>(std::min(message.size(), sizeof(a_slot.text)));
+        std::memcpy(a_slot.text, message.data(), a_slot.size);
+
+        sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // Returns the published entries of a ring file, oldest first, and fails on a malformed one.
+    static bool Read(std::istream &in, std::vector<Entry> &entries) {
+        Header header {};
+        if (not in.read(reinterpret_cast<char *>(&header), sizeof(header)) or
+            std::string_view {header.magic, sizeof(header.magic)} != MAGIC or
+            not header.slot_count) {
+            return false;
+        }
+
+        entries.clear();
+        Slot a_slot {};
+        for (std::uint64_t i = 0; i < header.slot_count; ++i) {
+            if (not in.read(reinterpret_cast<char *>(&a_slot), sizeof(a_slot))) {
+                return false;
+            }
+
+            if (a_slot.sequence and (a_slot.sequence - 1) % header.slot_count == i and
+                a_slot.size <= sizeof(a_slot.text)) {
+                entries.push_back(Entry {a_slot.sequence,
+                                         a_slot.nanoseconds,
+                                         a_slot.level,
+                                         std::string(a_slot.text, a_slot.size)});
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+            return a.sequence < b.sequence;
+        });
+        return true;
+    }
+
+private:
+    static inline std::atomic<FlightRecorder *> m_installed {nullptr};
+
+    const std::size_t m_mask;
+    const std::size_t m_size;
+    Header *m_header = nullptr;
+    Slot *m_slots = nullptr;
+};
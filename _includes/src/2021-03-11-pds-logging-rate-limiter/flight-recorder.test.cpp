@@ -0,0 +1,100 @@
+// flight-recorder.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "flight-recorder.hpp"
+#include "recorded-sink.hpp"
+
+
+class FlightRecorderTests : public ::testing::Test {
+protected:
+    std::vector<std::string> readTexts(const std::filesystem::path &path) const {
+        std::ifstream in {path, std::ios::binary};
+        std::vector<FlightRecorder::Entry> entries;
+        EXPECT_TRUE(FlightRecorder::Read(in, entries));
+
+        std::vector<std::string> texts;
+        for (const auto &an_entry : entries) {
+            texts.push_back(std::string {an_entry.level} + ' ' + an_entry.text);
+        }
+        return texts;
+    }
+
+    std::vector<std::string> readTexts() const {
+        return readTexts(m_path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(m_path);
+        std::filesystem::remove(FlightRecorder::PreviousPath(m_path));
+    }
+
+    const std::filesystem::path m_path =
+        std::filesystem::temp_directory_path() /
+        ("flight-recorder." + std::to_string(::getpid()) + ".ring");
+};
+
+TEST_F(FlightRecorderTests, TestKeepsLatestRecordsInOrder) {
+    FlightRecorder recorder {m_path, 4};
+    for (auto i = 0; i < 10; ++i) {
+        recorder.Record(i, 'I', "record " + std::to_string(i));
+    }
+
+    EXPECT_EQ((std::vector<std::string> {"I record 6", "I record 7", "I record 8", "I record 9"}),
+              readTexts());
+}
+
+TEST_F(FlightRecorderTests, TestTruncatesLongMessages) {
+    FlightRecorder recorder {m_path, 4};
+    recorder.Record(0, 'E', std::string(1000, 'x'));
+
+    const auto texts = readTexts();
+    ASSERT_EQ(1, texts.size());
+    EXPECT_EQ(2 + sizeof(FlightRecorder::Slot::text), texts.front().size());
+}
+
+TEST_F(FlightRecorderTests, TestKeepsPreviousRing) {
+    {
+        FlightRecorder recorder {m_path, 4};
+        recorder.Record(0, 'E', "before restart");
+    }
+
+    FlightRecorder recorder {m_path, 4};
+    recorder.Record(1, 'I', "after restart");
+    EXPECT_EQ(std::vector<std::string> {"I after restart"}, readTexts());
+    EXPECT_EQ(std::vector<std::string> {"E before restart"},
+              readTexts(FlightRecorder::PreviousPath(m_path)));
+}
+
+TEST_F(FlightRecorderTests, TestRejectsMalformedRing) {
+    std::istringstream in {"not a flight recorder"};
+    std::vector<FlightRecorder::Entry> entries;
+    EXPECT_FALSE(FlightRecorder::Read(in, entries));
+}
+
+TEST_F(FlightRecorderTests, TestSurvivesCrash) {
+    const auto child = ::fork();
+    ASSERT_LE(0, child);
+    if (child == 0) {
+        std::cout.rdbuf(nullptr);
+        FlightRecorder::Install(m_path);
+        const RecordedSink<> logger;
+        logger.Log(Logpp::Level::info, "started");
+        logger.Log(Logpp::Level::error, "about to crash");
+        ::raise(SIGSEGV);
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ((std::vector<std::string> {"I started", "E about to crash"}), readTexts());
+}
@@ -0,0 +1,27 @@
+// format-logging.hpp
+
+#pragma once
+
+#include <type_traits>
+
+#include "log-format.hpp"
+#include "logpp.hpp"
+
+// Gives Logger the Info and Error overloads that take a LogFormat, which hand its
+// log(level, message) a LogMessage. Logger befriends it and brings the overloads in next to its
+// own plain ones.
+template<typename Logger>
+class FormatLogging {
+public:
+    template<typename... Args>
+    bool Info(const LogFormat<std::type_identity_t<Args>...> format, const Args &...args) {
+        return static_cast<Logger &>(*this).log(Logpp::Level::info,
+                                                LogMessage<Args...> {format, args...});
+    }
+
+    template<typename... Args>
+    bool Error(const LogFormat<std::type_identity_t<Args>...> format, const Args &...args) {
+        return static_cast<Logger &>(*this).log(Logpp::Level::error,
+                                                LogMessage<Args...> {format, args...});
+    }
+};
@@ -0,0 +1,50 @@
+// gcra-logger.hpp
+
+#pragma once
+
+#include "format-logging.hpp"
+#include "gcra.hpp"
+#include "logpp.hpp"
+
+template<typename Clock = std::chrono::steady_clock, typename Sink = Logpp>
+class GcraLogger : public FormatLogging<GcraLogger<Clock, Sink>> {
+public:
+    using FormatLogging<GcraLogger>::Info;
+    using FormatLogging<GcraLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
+    }
+
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
+    }
+
+    explicit GcraLogger(const long log_per_second = 100) : m_limiter(Rate {log_per_second}) {
+    }
+
+    void SetRate(const long log_per_second) {
+        m_limiter.Reload(Rate {log_per_second});
+    }
+
+private:
+    friend FormatLogging<GcraLogger>;
+
+    template<typename Message>
+    bool log(const Logpp::Level a_level, const Message &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        if (m_limiter.FetchToken()) {
+            if (m_logger.Log(a_level, MessageOf(message))) {
+                return true;
+            }
+            m_limiter.Return();
+        }
+        return false;
+    }
+
+    ReloadableGcraLimiter<Clock> m_limiter;
+    Sink m_logger;
+};
@@ -0,0 +1,6 @@
+#include "gcra-logger.hpp"
+#include "test-utils.hpp"
+
+int main() {
+    TestLimiterLogger(GcraLogger {3});
+}
@@ -0,0 +1,176 @@
+// gcra.hpp
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+
+#include "clocks.hpp"
+#include "hot-path.hpp"
+#include "rate.hpp"
+#include "reloadable.hpp"
+
+// Generic Cell Rate Algorithm: the whole state is the theoretical arrival time (TAT) of
+// the next permit, so one policy can drive many 8-byte states, e.g. one per key.
+template<typename RateType = Rate>
+class GcraPolicy {
+public:
+    using State = std::atomic<std::int64_t>;
+
+    // A closed state is left untouched by every operation but Close().
+    static constexpr std::int64_t CLOSED = std::numeric_limits<std::int64_t>::min();
+
+    template<typename... Args>
+    explicit GcraPolicy(const Args &...args) : m_limits(args...) {
+        static_assert(State::is_always_lock_free and sizeof(State) == 8);
+    }
+
+    HOT_PATH bool Acquire(State &tat, const std::int64_t now) const {
+        return Reserve(tat, now, now).has_value();
+    }
+
+    // Reserves the next permit in FIFO order and returns when it becomes available, unless
+    // that is later than the deadline.
+    std::optional<std::int64_t> Reserve(
+        State &tat,
+        const std::int64_t now,
+        const std::int64_t deadline = std::numeric_limits<std::int64_t>::max()) const {
+        const auto interval = m_limits.IntervalNanoseconds();
+        const auto limit = burstWindow();
+
+        auto old_tat = tat.load(std::memory_order_relaxed);
+        while (old_tat != CLOSED) {
+            const auto new_tat = std::max(old_tat, now) + interval;
+            const auto ready = std::max(new_tat - limit, now);
+            if (ready > deadline) {
+                return std::nullopt;
+            }
+
+            if (tat.compare_exchange_weak(
+                    old_tat, new_tat, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                return ready;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    bool Release(State &tat) const {
+        auto old_tat = tat.load(std::memory_order_relaxed);
+        while (old_tat != CLOSED) {
+            if (tat.compare_exchange_weak(old_tat, old_tat - m_limits.IntervalNanoseconds(),
+                                          std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Closes tat and returns the TAT under which next has the same share of its burst window
+    // in use, so the permits left scale with the capacity.
+    template<typename OtherRate>
+    std::int64_t Close(State &tat,
+                       const GcraPolicy<OtherRate> &next,
+                       const std::int64_t now) const {
+        const auto debt = std::max(tat.exchange(CLOSED, std::memory_order_relaxed) - now,
+                                   std::int64_t {0});
+        return now + std::llround(static_cast<double>(debt) * next.burstWindow() / burstWindow());
+    }
+
+    static bool IsClosed(const State &tat) {
+        return tat.load(std::memory_order_relaxed) == CLOSED;
+    }
+
+private:
+    template<typename>
+    friend class GcraPolicy;
+
+    auto burstWindow() const {
+        return m_limits.IntervalNanoseconds() * m_limits.Capacity();
+    }
+
+    [[no_unique_address]] RateLimits<RateType> m_limits;
+};
+
+template<typename Clock = std::chrono::steady_clock, typename RateType = Rate>
+class GcraLimiter {
+public:
+    template<typename... Args>
+    explicit GcraLimiter(const Args &...args) : m_policy(args...) {
+    }
+
+    auto FetchToken() {
+        return m_policy.Acquire(m_tat, NanosecondsOf<Clock>(Clock::now()));
+    }
+
+    void Return() {
+        m_policy.Release(m_tat);
+    }
+
+private:
+    GcraPolicy<RateType> m_policy;
+    typename GcraPolicy<RateType>::State m_tat {0};
+};
+
+// A GcraLimiter whose rate may be reloaded while other threads fetch tokens. Every version
+// owns its TAT, and a reload closes the old one before carrying it over, so a permit is
+// neither lost nor granted twice.
+template<typename Clock = std::chrono::steady_clock>
+class ReloadableGcraLimiter {
+public:
+    template<typename... Args>
+    explicit ReloadableGcraLimiter(const Args &...args) : m_versions(RateLimits<> {args...}) {
+    }
+
+    HOT_PATH bool FetchToken() {
+        const auto now = NanosecondsOf<Clock>(Clock::now());
+        while (true) {
+            const auto version = m_versions.Read();
+            if (version->policy.Acquire(version->tat, now)) {
+                return true;
+            }
+            if (not GcraPolicy<>::IsClosed(version->tat)) {
+                return false;
+            }
+        }
+    }
+
+    void Return() {
+        while (true) {
+            const auto version = m_versions.Read();
+            if (version->policy.Release(version->tat)) {
+                return;
+            }
+        }
+    }
+
+    template<typename... Args>
+    void Reload(const Args &...args) {
+        const RateLimits<> limits {args...};
+        m_versions.Update([&limits](Version &current) {
+            auto next = std::make_unique<Version>(limits);
+            next->tat.store(current.policy.Close(current.tat, next->policy,
+                                                 NanosecondsOf<Clock>(Clock::now())),
+                            std::memory_order_relaxed);
+            return next;
+        });
+    }
+
+private:
+    struct Version {
+        explicit Version(const RateLimits<> &limits) : policy(limits) {
+        }
+
+        GcraPolicy<> policy;
+        GcraPolicy<>::State tat {0};
+    };
+
+    Reloadable<Version> m_versions;
+};
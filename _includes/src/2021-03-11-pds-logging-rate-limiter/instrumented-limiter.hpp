@@ -0,0 +1,18 @@
+// instrumented-limiter.hpp
+
+#pragma once
+
+#include "perf-region.hpp"
+#include "token-bucket.hpp"
+
+// Counts the hardware events of the FetchToken calls it forwards to Limiter.
+template<typename Limiter = TokenBucketLimiter<>>
+class InstrumentedLimiter : public Limiter {
+public:
+    using Limiter::Limiter;
+
+    auto FetchToken() {
+        PERF_REGION("TokenBucketLimiter::FetchToken");
+        return Limiter::FetchToken();
+    }
+};
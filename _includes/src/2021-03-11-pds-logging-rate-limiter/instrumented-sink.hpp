@@ -0,0 +1,21 @@
+// instrumented-sink.hpp
+
+#pragma once
+
+#include <string_view>
+
+#include "logpp.hpp"
+#include "perf-region.hpp"
+
+// Counts the hardware events of the Log calls it forwards to Sink.
+template<typename Sink = Logpp>
+class InstrumentedSink {
+public:
+    auto Log(const Logpp::Level a_level, const std::string_view message) const {
+        PERF_REGION("Logpp::Log");
+        return m_sink.Log(a_level, message);
+    }
+
+private:
+    Sink m_sink;
+};
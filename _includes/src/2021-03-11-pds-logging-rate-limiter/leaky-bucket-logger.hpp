@@ -2,87 +2,133 @@
 
 #pragma once
 
-#include <atomic>
-#include <condition_variable>
 #include <mutex>
 #include <queue>
-#include <thread>
+#include <string>
+#include <utility>
 
+#include "format-logging.hpp"
 #include "logpp.hpp"
 #include "rate.hpp"
+#include "timer-wheel.hpp"
 
-class LeakyBucketLogger {
+class LeakyBucketLogger : public FormatLogging<LeakyBucketLogger> {
 public:
-    void Info(std::string message) {
-        log(Logpp::Level::info, std::move(message));
+    using FormatLogging<LeakyBucketLogger>::Info;
+    using FormatLogging<LeakyBucketLogger>::Error;
+
+    bool Info(std::string message) {
+        return log(Logpp::Level::info, std::move(message));
     }
 
-    void Error(const std::string message) {
-        log(Logpp::Level::error, std::move(message));
+    bool Error(const std::string message) {
+        return log(Logpp::Level::error, std::move(message));
     }
 
-    explicit LeakyBucketLogger(const long log_per_second = 100) :
-        m_rate(log_per_second), m_capacity(log_per_second) {
+    explicit LeakyBucketLogger(const long log_per_second = 100,
+                               TimerWheel &wheel = TimerWheel::Shared()) :
+        m_rate(log_per_second), m_capacity(log_per_second), m_wheel(wheel) {
     }
 
+    LeakyBucketLogger(const LeakyBucketLogger &) = delete;
+    LeakyBucketLogger &operator=(const LeakyBucketLogger &) = delete;
+
     ~LeakyBucketLogger() {
-        m_abort = true;
-        m_queue_cv.notify_all();
-        if (m_thread.joinable()) {
-            m_thread.join();
+        TimerWheel::Handle drain;
+        {
+            std::lock_guard<std::mutex> guard {m_queue_mutex};
+            m_abort = true;
+            drain = m_drain;
         }
+        m_wheel.Cancel(drain);
+        Flush();
     }
 
     void Start() {
-        if (not m_thread.joinable()) {
-            m_thread = std::thread(&LeakyBucketLogger::run, this);
-        }
+        std::lock_guard<std::mutex> guard {m_queue_mutex};
+        m_started = true;
+        scheduleDrain();
     }
 
-private:
-    void log(const Logpp::Level a_level, std::string message) {
+    // Applies from the drain after the one already scheduled, and resizes the queue to match.
+    void SetRate(const long log_per_second) {
+        std::lock_guard<std::mutex> guard {m_queue_mutex};
+        m_rate = Rate {log_per_second};
+        m_capacity = static_cast<std::size_t>(log_per_second);
+    }
+
+    // Writes out whatever is still queued, regardless of the rate.
+    void Flush() {
+        std::lock_guard<std::mutex> logging {m_logger_mutex};
+        std::queue<std::pair<Logpp::Level, std::string>> pending;
         {
             std::lock_guard<std::mutex> guard {m_queue_mutex};
-            if (m_queue.size() < m_capacity) {
-                m_queue.emplace(a_level, std::move(message));
-            }
+            std::swap(pending, m_queue);
         }
 
-        m_queue_cv.notify_one();
+        for (; not pending.empty(); pending.pop()) {
+            const auto &[a_level, message] = pending.front();
+            m_logger.Log(a_level, message);
+        }
     }
 
-    auto elapsed() const {
-        const auto now = std::chrono::steady_clock::now();
-        return now - m_last_time;
-    }
+private:
+    friend FormatLogging<LeakyBucketLogger>;
+
+    template<typename Message>
+    bool log(const Logpp::Level a_level, Message message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
 
-    void run() {
-        while (true) {
-            std::unique_lock<std::mutex> lock {m_queue_mutex};
+        std::lock_guard<std::mutex> guard {m_queue_mutex};
+        if (m_queue.size() < m_capacity) {
+            m_queue.emplace(a_level, MessageOf(std::move(message)));
+            scheduleDrain();
+            return true;
+        }
+        return false;
+    }
 
-            m_queue_cv.wait(lock, [this] {
-                return m_abort.load() or (not m_queue.empty() and elapsed() >= m_rate.Interval());
+    void scheduleDrain() {
+        if (m_started and not m_abort and not m_drain_pending and not m_queue.empty()) {
+            m_drain_pending = true;
+            m_drain = m_wheel.Schedule(m_last_time + m_rate.Interval(), [this] {
+                drain();
             });
-            if (m_abort.load()) {
-                break;
-            }
-
-            const auto &[a_level, message] = m_queue.front();
+        }
+    }
 
-            if (m_logger.Log(a_level, message)) {
-                m_last_time = std::chrono::steady_clock::now();
+    // Runs on the wheel's thread. Only m_logger_mutex, which keeps the messages in order, is held
+    // while logging, so loggers never wait for the sink.
+    void drain() {
+        std::lock_guard<std::mutex> logging {m_logger_mutex};
+        std::pair<Logpp::Level, std::string> entry;
+        {
+            std::lock_guard<std::mutex> guard {m_queue_mutex};
+            m_drain_pending = false;
+            if (m_abort or m_queue.empty()) {
+                return;
             }
 
+            entry = std::move(m_queue.front());
             m_queue.pop();
         }
-    }
 
-    std::thread m_thread;
+        const auto &[a_level, message] = entry;
+        const auto logged = m_logger.Log(a_level, message);
+
+        std::lock_guard<std::mutex> guard {m_queue_mutex};
+        if (logged) {
+            m_last_time = std::chrono::steady_clock::now();
+        }
+        scheduleDrain();
+    }
 
     std::mutex m_queue_mutex;
-    std::condition_variable m_queue_cv;
     std::queue<std::pair<Logpp::Level, std::string>> m_queue;
 
+    std::mutex m_logger_mutex;
     Logpp m_logger;
 
     Rate m_rate {0};
@@ -90,5 +136,9 @@ private:
         std::chrono::steady_clock::now();
     std::size_t m_capacity = 0;
 
-    std::atomic<bool> m_abort {false};
+    TimerWheel &m_wheel;
+    TimerWheel::Handle m_drain;
+    bool m_drain_pending = false;
+    bool m_started = false;
+    bool m_abort = false;
 };
@@ -0,0 +1,134 @@
+// leaky-bucket-logger.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "leaky-bucket-logger.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Records when each line written through it ends, taking line_delay to write each one.
+class LineTimesBuf : public std::streambuf {
+public:
+    explicit LineTimesBuf(const Clock::duration line_delay = {}) : m_line_delay(line_delay) {
+    }
+
+    auto Times() const {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        return m_times;
+    }
+
+    bool IsWriting() const {
+        return m_writing.load();
+    }
+
+protected:
+    virtual int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::to_int_type('\n'))) {
+            m_writing = true;
+            std::this_thread::sleep_for(m_line_delay);
+            m_writing = false;
+
+            std::lock_guard<std::mutex> guard {m_mutex};
+            m_times.push_back(Clock::now());
+        }
+        return traits_type::not_eof(c);
+    }
+
+private:
+    const Clock::duration m_line_delay;
+    std::atomic<bool> m_writing {false};
+    mutable std::mutex m_mutex;
+    std::vector<Clock::time_point> m_times;
+};
+
+class LeakyBucketLoggerTests : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::cout.rdbuf(m_original);
+    }
+
+    template<typename Predicate>
+    static bool waitFor(const Predicate &predicate) {
+        const auto end = Clock::now() + 5s;
+        while (not predicate() and Clock::now() < end) {
+            std::this_thread::sleep_for(1ms);
+        }
+        return predicate();
+    }
+
+    std::streambuf *const m_original = std::cout.rdbuf();
+    TimerWheel m_wheel;
+};
+
+TEST_F(LeakyBucketLoggerTests, TestDrainsAtConfiguredRate) {
+    constexpr std::size_t MESSAGE_COUNT = 6;
+    constexpr auto INTERVAL = 50ms;
+
+    LineTimesBuf lines;
+    std::cout.rdbuf(&lines);
+    LeakyBucketLogger logger {1s / INTERVAL, m_wheel};
+    for (std::size_t i = 0; i < MESSAGE_COUNT; ++i) {
+        ASSERT_TRUE(logger.Info("queued"));
+    }
+    logger.Start();
+
+    ASSERT_TRUE(waitFor([&lines] {
+        return lines.Times().size() == MESSAGE_COUNT;
+    }));
+    const auto times = lines.Times();
+    for (std::size_t i = 1; i < times.size(); ++i) {
+        EXPECT_LE(INTERVAL, times[i] - times[i - 1]) << "message " << i;
+    }
+}
+
+TEST_F(LeakyBucketLoggerTests, TestSetRateChangesDrainInterval) {
+    constexpr std::size_t MESSAGE_COUNT = 8;
+    constexpr auto SLOW_INTERVAL = 100ms;
+    constexpr auto FAST_INTERVAL = 10ms;
+
+    LineTimesBuf lines;
+    std::cout.rdbuf(&lines);
+    LeakyBucketLogger logger {1s / SLOW_INTERVAL, m_wheel};
+    for (std::size_t i = 0; i < MESSAGE_COUNT; ++i) {
+        ASSERT_TRUE(logger.Info("queued"));
+    }
+    logger.Start();
+    ASSERT_TRUE(waitFor([&lines] {
+        return lines.Times().size() == 2;
+    }));
+    logger.SetRate(1s / FAST_INTERVAL);
+
+    ASSERT_TRUE(waitFor([&lines] {
+        return lines.Times().size() == MESSAGE_COUNT;
+    }));
+    const auto times = lines.Times();
+    EXPECT_LE(SLOW_INTERVAL, times[1] - times[0]);
+    // The drain that was scheduled before the change still waits the old interval.
+    for (std::size_t i = 4; i < times.size(); ++i) {
+        EXPECT_LE(FAST_INTERVAL, times[i] - times[i - 1]) << "message " << i;
+        EXPECT_GT(SLOW_INTERVAL, times[i] - times[i - 1]) << "message " << i;
+    }
+}
+
+TEST_F(LeakyBucketLoggerTests, TestLoggingDoesNotWaitForDrain) {
+    LineTimesBuf lines {200ms};
+    std::cout.rdbuf(&lines);
+    LeakyBucketLogger logger {1000, m_wheel};
+    ASSERT_TRUE(logger.Info("slow"));
+    logger.Start();
+    ASSERT_TRUE(waitFor([&lines] {
+        return lines.IsWriting();
+    }));
+
+    const auto start = Clock::now();
+    EXPECT_TRUE(logger.Info("queued"));
+    EXPECT_GT(100ms, Clock::now() - start);
+    EXPECT_TRUE(lines.IsWriting());
+}
@@ -1,8 +1,9 @@
+#include "flush-on-shutdown.hpp"
 #include "leaky-bucket-logger.hpp"
 #include "test-utils.hpp"
 
 int main() {
-    LeakyBucketLogger logger {3};
+    FlushOnShutdown<LeakyBucketLogger, ShutdownRegistry::QUEUE_PRIORITY> logger {3};
     logger.Start();
     TestLimiterLogger(logger);
 }
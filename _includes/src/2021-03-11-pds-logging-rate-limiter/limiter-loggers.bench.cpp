@@ -0,0 +1,249 @@
+// limiter-loggers.bench.cpp
+
+#include <benchmark/benchmark.h>
+
+#include "binary-log.hpp"
+#include "flight-recorder.hpp"
+#include "gcra-logger.hpp"
+#include "leaky-bucket-logger.hpp"
+#include "sliding-log-logger.hpp"
+#include "sliding-window-counter-logger.hpp"
+#include "suppressing-logger.hpp"
+#include "token-bucket-logger.hpp"
+
+class NullCout {
+public:
+    NullCout() : m_original(std::cout.rdbuf(&m_null)) {
+    }
+
+    NullCout(const NullCout &) = delete;
+    NullCout &operator=(const NullCout &) = delete;
+
+    ~NullCout() {
+        std::cout.rdbuf(m_original);
+    }
+
+private:
+    class NullBuf : public std::streambuf {
+    protected:
+        virtual int_type overflow(int_type c) override {
+            return traits_type::not_eof(c);
+        }
+
+        virtual std::streamsize xsputn(const char_type *, std::streamsize n) override {
+            return n;
+        }
+    };
+
+    NullBuf m_null;
+    std::streambuf *m_original = nullptr;
+};
+
+template<typename Logger>
+void StartIfAsync(Logger &) {
+}
+
+void StartIfAsync(LeakyBucketLogger &logger) {
+    logger.Start();
+}
+
+constexpr long REJECTING_RATE = 1;
+constexpr long ADMITTING_RATE = 1'000'000'000;
+constexpr long QUEUEING_RATE = 100'000;
+
+template<typename Logger>
+static void BM_LoggerInfo(benchmark::State &state) {
+    const NullCout null_cout;
+    {
+        Logger logger {state.range(0)};
+        StartIfAsync(logger);
+
+        for (auto _ : state) {
+            logger.Info("benchmark message");
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_LoggerInfo, LeakyBucketLogger)
+    ->ArgName("log_per_second")
+    ->Arg(REJECTING_RATE)
+    ->Arg(QUEUEING_RATE);
+BENCHMARK_TEMPLATE(BM_LoggerInfo, SlidingLogLogger<>)
+    ->ArgName("log_per_second")
+    ->Arg(REJECTING_RATE)
+    ->Arg(ADMITTING_RATE);
+BENCHMARK_TEMPLATE(BM_LoggerInfo, SlidingWindowCounterLogger<>)
+    ->ArgName("log_per_second")
+    ->Arg(REJECTING_RATE)
+    ->Arg(ADMITTING_RATE);
+BENCHMARK_TEMPLATE(BM_LoggerInfo, TokenBucketLogger<>)
+    ->ArgName("log_per_second")
+    ->Arg(REJECTING_RATE)
+    ->Arg(ADMITTING_RATE);
+BENCHMARK_TEMPLATE(BM_LoggerInfo, GcraLogger<>)
+    ->ArgName("log_per_second")
+    ->Arg(REJECTING_RATE)
+    ->Arg(ADMITTING_RATE);
+
+template<typename Logger>
+static void BM_RejectedStringMessage(benchmark::State &state) {
+    const NullCout null_cout;
+    Logger logger {REJECTING_RATE};
+    const std::string name {"rate-limited benchmark"};
+
+    long i = 0;
+    for (auto _ : state) {
+        logger.Info("message " + std::to_string(++i) + " from " + name);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Logger>
+static void BM_RejectedFormattedMessage(benchmark::State &state) {
+    const NullCout null_cout;
+    Logger logger {REJECTING_RATE};
+    const std::string name {"rate-limited benchmark"};
+
+    long i = 0;
+    for (auto _ : state) {
+        logger.Info("message {} from {}", ++i, name);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Logger>
+static void BM_FilteredMessage(benchmark::State &state) {
+    const NullCout null_cout;
+    Logger logger {ADMITTING_RATE};
+    const std::string name {"rate-limited benchmark"};
+    Logpp::SetLevel(Logpp::Level::error);
+
+    long i = 0;
+    for (auto _ : state) {
+        logger.Info("message {} from {}", ++i, name);
+    }
+
+    Logpp::SetLevel(Logpp::Level::debug);
+    state.SetItemsProcessed(state.iterations());
+}
+
+class NullSink {
+public:
+    bool Log(const Logpp::Level, const std::string_view) const {
+        return true;
+    }
+};
+
+static void BM_SuppressedRepeat(benchmark::State &state) {
+    using Clock = std::chrono::steady_clock;
+    static SuppressingLogger<TokenBucketLogger<Clock, NullSink>, Clock, NullSink> logger {
+        SuppressionSettings {}, ADMITTING_RATE};
+    const std::string name {"rate-limited benchmark"};
+
+    long i = 0;
+    for (auto _ : state) {
+        logger.Info("message {} from {}", ++i, name);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_RejectedStringMessage, TokenBucketLogger<>);
+BENCHMARK_TEMPLATE(BM_RejectedFormattedMessage, TokenBucketLogger<>);
+BENCHMARK_TEMPLATE(BM_RejectedStringMessage, LeakyBucketLogger);
+BENCHMARK_TEMPLATE(BM_RejectedFormattedMessage, LeakyBucketLogger);
+BENCHMARK_TEMPLATE(BM_FilteredMessage, TokenBucketLogger<>);
+BENCHMARK_TEMPLATE(BM_FilteredMessage, LeakyBucketLogger);
+BENCHMARK(BM_SuppressedRepeat)->Threads(1)->Threads(4);
+
+static void BM_FlightRecord(benchmark::State &state) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("flight-recorder.bench." + std::to_string(::getpid()));
+    const std::string message {"rate-limited benchmark message"};
+    {
+        FlightRecorder recorder {path};
+        long i = 0;
+        for (auto _ : state) {
+            recorder.Record(++i, 'I', message);
+        }
+    }
+
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FlightRecord);
+
+constexpr long BATCH_SIZE = 64;
+
+static void BM_TokenBucketPerMessage(benchmark::State &state) {
+    const NullCout null_cout;
+    TokenBucketLimiter limiter {Rate {ADMITTING_RATE}};
+    const Logpp logger;
+
+    for (auto _ : state) {
+        for (auto i = 0; i < BATCH_SIZE; ++i) {
+            if (const auto a_token = limiter.FetchToken()) {
+                logger.Log(Logpp::Level::info, "benchmark message");
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+static void BM_TokenBucketBatch(benchmark::State &state) {
+    const NullCout null_cout;
+    TokenBucketLimiter limiter {Rate {ADMITTING_RATE}};
+    const Logpp logger;
+
+    for (auto _ : state) {
+        auto a_lease = limiter.FetchTokens(BATCH_SIZE, TokenBucketLimiter<>::FetchMode::partial);
+        for (auto i = 0; i < a_lease.Count(); ++i) {
+            logger.Log(Logpp::Level::info, "benchmark message");
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+BENCHMARK(BM_TokenBucketPerMessage);
+BENCHMARK(BM_TokenBucketBatch);
+
+template<typename Logger>
+static void BM_BinaryLoggerInfo(benchmark::State &state) {
+    const NullCout null_cout;
+    const BinaryLogWriter writer {std::cout};
+    Logger logger {state.range(0)};
+
+    for (auto _ : state) {
+        logger.Info("benchmark message");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_BinaryLogStatement(benchmark::State &state) {
+    const NullCout null_cout;
+    const BinaryLogWriter writer {std::cout};
+    const BinaryLogpp logger;
+
+    long dropped = 0;
+    for (auto _ : state) {
+        if (not BINARY_LOG(logger, Logpp::Level::info, "message {} of {}", dropped, 0.5)) {
+            ++dropped;
+        }
+    }
+
+    state.counters["dropped"] = dropped;
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_BinaryLoggerInfo, TokenBucketLogger<std::chrono::steady_clock, BinaryLogpp>)
+    ->ArgName("log_per_second")
+    ->Arg(ADMITTING_RATE);
+BENCHMARK(BM_BinaryLogStatement);
@@ -0,0 +1,164 @@
+// limiters.bench.cpp
+
+#include <benchmark/benchmark.h>
+
+#include "clocks.hpp"
+#include "gcra.hpp"
+#include "hot-path.hpp"
+#include "multi-window-counter.hpp"
+#include "sharded-token-bucket.hpp"
+#include "token-bucket.hpp"
+
+constexpr long HIGH_RATE = 5'000'000;
+constexpr std::size_t SHARD_COUNT = 64;
+
+template<typename Limiter>
+auto &SharedLimiter() {
+    static Limiter limiter {Rate {HIGH_RATE}};
+    return limiter;
+}
+
+template<>
+auto &SharedLimiter<ShardedTokenBucketLimiter<>>() {
+    static ShardedTokenBucketLimiter<> limiter {Rate {HIGH_RATE}, HIGH_RATE, SHARD_COUNT};
+    return limiter;
+}
+
+template<typename Limiter>
+static void BM_FetchToken(benchmark::State &state) {
+    auto &limiter = SharedLimiter<Limiter>();
+
+    long granted = 0;
+    for (auto _ : state) {
+        granted += limiter.FetchToken() ? 1 : 0;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["granted_per_second"] =
+        benchmark::Counter(granted, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_TEMPLATE(BM_FetchToken, GcraLimiter<>)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(32)
+    ->Threads(64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FetchToken, ShardedTokenBucketLimiter<>)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(32)
+    ->Threads(64)
+    ->UseRealTime();
+
+constexpr long BATCH_SIZE = 64;
+constexpr long UNLIMITED_CAPACITY = 1L << 40;
+
+// The fetches of TokenBucketLimiter, cloned for HOT_PATH.
+HOT_PATH auto HotFetchToken(TokenBucketLimiter<> &limiter) {
+    return limiter.FetchToken();
+}
+
+HOT_PATH auto HotFetchTokens(TokenBucketLimiter<> &limiter, const long n) {
+    return limiter.FetchTokens(n);
+}
+
+static void BM_TokenBucketFetchToken(benchmark::State &state) {
+    TokenBucketLimiter limiter {Rate {HIGH_RATE}, UNLIMITED_CAPACITY};
+
+    for (auto _ : state) {
+        for (auto i = 0; i < BATCH_SIZE; ++i) {
+            benchmark::DoNotOptimize(HotFetchToken(limiter));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+static void BM_TokenBucketFetchTokens(benchmark::State &state) {
+    TokenBucketLimiter limiter {Rate {HIGH_RATE}, UNLIMITED_CAPACITY};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(HotFetchTokens(limiter, BATCH_SIZE));
+    }
+
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+BENCHMARK(BM_TokenBucketFetchToken);
+BENCHMARK(BM_TokenBucketFetchTokens);
+
+static void BM_MultiWindowCounter(benchmark::State &state) {
+    MultiWindowCounter<Tier<100, std::chrono::seconds>, Tier<2000, std::chrono::minutes>,
+                       Tier<50000, std::chrono::hours>>
+        counter;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(counter.TryAcquire());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MultiWindowCounter);
+
+template<typename Clock>
+static void BM_ClockNow(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Clock::now());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Clock>
+static void BM_GcraFetchToken(benchmark::State &state) {
+    GcraLimiter<Clock> limiter {Rate {HIGH_RATE}};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(limiter.FetchToken());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_ClockNow, std::chrono::steady_clock);
+BENCHMARK_TEMPLATE(BM_ClockNow, TscClock);
+BENCHMARK_TEMPLATE(BM_ClockNow, ManualClock);
+BENCHMARK_TEMPLATE(BM_GcraFetchToken, std::chrono::steady_clock);
+BENCHMARK_TEMPLATE(BM_GcraFetchToken, TscClock);
+BENCHMARK_TEMPLATE(BM_GcraFetchToken, ManualClock);
+
+using HighStaticRate = StaticRate<HIGH_RATE>;
+
+template<typename Limiter>
+void RunWithManualClock(benchmark::State &state, Limiter &limiter) {
+    ManualClock::Reset();
+    long granted = 0;
+    for (auto _ : state) {
+        ManualClock::Advance(100ns);
+        granted += limiter.FetchToken() ? 1 : 0;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["granted"] = granted;
+}
+
+template<template<typename, typename> typename Limiter>
+static void BM_RuntimeRate(benchmark::State &state) {
+    Limiter<ManualClock, Rate> limiter {Rate {HIGH_RATE}};
+    RunWithManualClock(state, limiter);
+}
+
+template<template<typename, typename> typename Limiter>
+static void BM_StaticRate(benchmark::State &state) {
+    Limiter<ManualClock, HighStaticRate> limiter;
+    RunWithManualClock(state, limiter);
+}
+
+BENCHMARK_TEMPLATE(BM_RuntimeRate, GcraLimiter);
+BENCHMARK_TEMPLATE(BM_StaticRate, GcraLimiter);
+BENCHMARK_TEMPLATE(BM_RuntimeRate, TokenBucketLimiter);
+BENCHMARK_TEMPLATE(BM_StaticRate, TokenBucketLimiter);
+BENCHMARK_TEMPLATE(BM_RuntimeRate, ShardedTokenBucketLimiter);
+BENCHMARK_TEMPLATE(BM_StaticRate, ShardedTokenBucketLimiter);
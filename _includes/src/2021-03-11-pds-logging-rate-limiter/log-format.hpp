@@ -0,0 +1,147 @@
+// log-format.hpp
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template<typename T>
+inline constexpr bool IS_LOG_ARGUMENT =
+    std::is_arithmetic_v<T> or std::is_convertible_v<const T &, std::string_view>;
+
+// Appends the text of format from position up to its next placeholder, and returns where the
+// placeholder starts.
+inline std::size_t AppendLogLiteral(std::string &out,
+                                    const std::string_view format,
+                                    std::size_t position) {
+    while (position < format.size()) {
+        const auto c = format[position];
+        if (c == '{' and position + 1 < format.size() and format[position + 1] == '}') {
+            break;
+        }
+
+        out += c;
+        position += c == '{' or c == '}' ? 2 : 1;
+    }
+    return position;
+}
+
+template<typename T>
+void AppendLogArg(std::string &out, const T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out += value ? "true" : "false";
+    } else if constexpr (std::is_same_v<T, char>) {
+        out += value;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    } else {
+        out += std::string_view {value};
+    }
+}
+
+// A format string checked at compile time against the types of its arguments. Every "{}" is
+// replaced by the next argument, and "{{" and "}}" stand for literal braces.
+template<typename... Args>
+class LogFormat {
+public:
+    template<typename T>
+        requires std::is_convertible_v<const T &, std::string_view>
+    consteval LogFormat(const T &format) : m_format(format) {
+        if (not IsValid(m_format)) {
+            invalidFormat();
+        }
+    }
+
+    static constexpr bool IsValid(const std::string_view format) {
+        std::size_t placeholders = 0;
+        for (std::size_t i = 0; i < format.size(); ++i) {
+            const auto next = i + 1 < format.size() ? format[i + 1] : '\0';
+            if (format[i] == '{' and next == '}') {
+                ++placeholders;
+                ++i;
+            } else if (format[i] == '{' or format[i] == '}') {
+                if (next != format[i]) {
+                    return false;
+                }
+                ++i;
+            }
+        }
+        return placeholders == sizeof...(Args);
+    }
+
+    std::string_view Format() const {
+        return m_format;
+    }
+
+    void FormatTo(std::string &out, const Args &...args) const {
+        std::size_t position = 0;
+        ((position = AppendLogLiteral(out, m_format, position) + 2, AppendLogArg(out, args)), ...);
+        AppendLogLiteral(out, m_format, position);
+    }
+
+private:
+    static_assert((IS_LOG_ARGUMENT<Args> and ...), "Unsupported log argument");
+
+    static void invalidFormat() {
+    }
+
+    std::string_view m_format;
+};
+
+// Formats into a buffer of the calling thread, which stays valid until its next call.
+template<typename... Args>
+std::string_view FormatLog(const LogFormat<std::type_identity_t<Args>...> format,
+                           const Args &...args) {
+    thread_local std::string buffer;
+    buffer.clear();
+    format.FormatTo(buffer, args...);
+    return buffer;
+}
+
+// The format and arguments of a call, formatted by operator() once the message is admitted.
+template<typename... Args>
+class LogMessage {
+public:
+    LogMessage(const LogFormat<Args...> format, const Args &...args) :
+        m_format(format), m_args(args...) {
+    }
+
+    std::string_view operator()() const {
+        return Apply(FormatLog<Args...>);
+    }
+
+    std::string_view Format() const {
+        return m_format.Format();
+    }
+
+    // Calls log(format, args...), to pass the message on unformatted.
+    template<typename Log>
+    decltype(auto) Apply(const Log &log) const {
+        return std::apply(
+            [&](const auto &...args) -> decltype(auto) {
+                return log(m_format, args...);
+            },
+            m_args);
+    }
+
+private:
+    LogFormat<Args...> m_format;
+    std::tuple<const Args &...> m_args;
+};
+
+// A logger takes either a message or a callable that builds it once the message is admitted.
+template<typename Message>
+decltype(auto) MessageOf(Message &&message) {
+    if constexpr (std::is_invocable_v<Message &>) {
+        return message();
+    } else {
+        return std::forward<Message>(message);
+    }
+}
@@ -0,0 +1,59 @@
+// log-format.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "clocks.hpp"
+#include "gcra-logger.hpp"
+#include "log-format.hpp"
+
+
+static_assert(LogFormat<int, int>::IsValid("{} of {}"));
+static_assert(LogFormat<>::IsValid("{{literal}}"));
+static_assert(not LogFormat<int>::IsValid("{} of {}"));
+static_assert(not LogFormat<int>::IsValid("{"));
+static_assert(not LogFormat<int>::IsValid("{x}"));
+static_assert(not LogFormat<>::IsValid("}"));
+
+TEST(LogFormatTests, TestFormatsArguments) {
+    const std::string name {"name"};
+    const auto message = FormatLog("{} of {}U: {}, {}, {}, {}", -3, 7U, 0.25, 'x', true, name);
+    EXPECT_EQ("-3 of 7U: 0.25, x, true, name", message);
+
+    EXPECT_EQ("{braces} 1", FormatLog("{{braces}} {}", 1));
+    EXPECT_EQ("", FormatLog(""));
+}
+
+class CountingArg {
+public:
+    operator std::string_view() const {
+        ++conversions;
+        return "arg";
+    }
+
+    static inline long conversions = 0;
+};
+
+class RecordingSink {
+public:
+    bool Log(const Logpp::Level, const std::string_view message) const {
+        messages.emplace_back(message);
+        return true;
+    }
+
+    static inline std::vector<std::string> messages;
+};
+
+TEST(LogFormatTests, TestFormatsOnlyAdmittedMessages) {
+    ManualClock::Reset(1s);
+    GcraLogger<ManualClock, RecordingSink> logger {1};
+
+    for (auto i = 0; i < 10; ++i) {
+        logger.Info("message {} with {}", i, CountingArg {});
+    }
+
+    EXPECT_EQ(1, CountingArg::conversions);
+    EXPECT_EQ(std::vector<std::string> {"message 0 with arg"}, RecordingSink::messages);
+}
@@ -0,0 +1,82 @@
+// log-level.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "clocks.hpp"
+#include "token-bucket-logger.hpp"
+
+
+static_assert(Logpp::MIN_LEVEL == Logpp::Level::info);
+static_assert(not Logpp::IsCompiledIn(Logpp::Level::debug));
+static_assert(Logpp::IsCompiledIn(Logpp::Level::info));
+
+class RecordingSink {
+public:
+    bool Log(const Logpp::Level, const std::string_view message) const {
+        messages.emplace_back(message);
+        return true;
+    }
+
+    static inline std::vector<std::string> messages;
+};
+
+class LogLevelTests : public ::testing::Test {
+protected:
+    void TearDown() override {
+        Logpp::SetLevel(Logpp::Level::debug);
+        RecordingSink::messages.clear();
+    }
+};
+
+TEST_F(LogLevelTests, TestArgumentsBelowCompileTimeFloorAreNotEvaluated) {
+    const RecordingSink sink;
+    long evaluations = 0;
+    const auto message = [&evaluations] {
+        ++evaluations;
+        return "message";
+    };
+
+    LOGPP_LOG(sink, debug, message());
+    EXPECT_EQ(0, evaluations);
+
+    LOGPP_LOG(sink, info, message());
+    EXPECT_EQ(1, evaluations);
+
+    Logpp::SetLevel(Logpp::Level::error);
+    LOGPP_LOG(sink, info, message());
+    EXPECT_EQ(1, evaluations);
+
+    LOGPP_LOG(sink, error, message());
+    EXPECT_EQ(2, evaluations);
+    EXPECT_EQ(2, RecordingSink::messages.size());
+}
+
+TEST_F(LogLevelTests, TestRuntimeLevel) {
+    EXPECT_FALSE(Logpp::IsEnabled(Logpp::Level::debug));
+    EXPECT_TRUE(Logpp::IsEnabled(Logpp::Level::info));
+
+    Logpp::SetLevel(Logpp::Level::warning);
+    EXPECT_FALSE(Logpp::IsEnabled(Logpp::Level::info));
+    EXPECT_TRUE(Logpp::IsEnabled(Logpp::Level::error));
+
+    Logpp::SetLevel(Logpp::Level::debug);
+    EXPECT_FALSE(Logpp::IsEnabled(Logpp::Level::debug));
+}
+
+TEST_F(LogLevelTests, TestFilteredMessagesDoNotConsumeTokens) {
+    ManualClock::Reset(1s);
+    TokenBucketLogger<ManualClock, RecordingSink> logger {1};
+
+    Logpp::SetLevel(Logpp::Level::error);
+    for (auto i = 0; i < 10; ++i) {
+        logger.Info("filtered");
+    }
+    EXPECT_TRUE(RecordingSink::messages.empty());
+
+    logger.Error("admitted");
+    logger.Error("rejected");
+    EXPECT_EQ(std::vector<std::string> {"admitted"}, RecordingSink::messages);
+}
@@ -2,12 +2,17 @@
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <iterator>
 #include <string_view>
 
 #include "chrono-utils.hpp"
 
+#ifndef LOGPP_MIN_LEVEL
+#define LOGPP_MIN_LEVEL debug
+#endif
+
 class Logpp {
 public:
     enum class Level {
@@ -18,10 +23,70 @@ public:
         critical = 'C',
     };
 
+    static constexpr Level MIN_LEVEL = Level::LOGPP_MIN_LEVEL;
+
+    static constexpr int Rank(const Level a_level) {
+        switch (a_level) {
+        case Level::debug:
+            return 0;
+        case Level::info:
+            return 1;
+        case Level::warning:
+            return 2;
+        case Level::error:
+            return 3;
+        case Level::critical:
+            return 4;
+        }
+        return 0;
+    }
+
+    static constexpr bool IsCompiledIn(const Level a_level) {
+        return Rank(a_level) >= Rank(MIN_LEVEL);
+    }
+
+    // Constant false below the compile-time floor, and one relaxed load above it.
+    static bool IsEnabled(const Level a_level) {
+        return IsCompiledIn(a_level) and
+               Rank(a_level) >= m_runtime_rank.load(std::memory_order_relaxed);
+    }
+
+    static void SetLevel(const Level a_level) {
+        m_runtime_rank.store(Rank(a_level), std::memory_order_relaxed);
+    }
+
     auto Log(const Level a_level, const std::string_view message) const {
+        if (not IsEnabled(a_level)) {
+            return true;
+        }
+
         const auto now = std::chrono::system_clock::now();
-        std::cout << '[' << now << ']' << '(' << static_cast<char>(a_level) << ") " << message
-                  << std::endl;
+        Format(std::cout, now, a_level, message) << std::endl;
         return true;
     }
+
+    static std::ostream &Format(std::ostream &out,
+                                const std::chrono::system_clock::time_point &tp,
+                                const Level a_level,
+                                const std::string_view message) {
+        return out << '[' << tp << ']' << '(' << static_cast<char>(a_level) << ") " << message;
+    }
+
+private:
+    static inline std::atomic<int> m_runtime_rank {0};
 };
+
+// Below the compile-time floor the statement, arguments included, is discarded.
+#define LOGPP_IF_ENABLED(level, statement)                                                 \
+    do {                                                                                   \
+        if constexpr (Logpp::IsCompiledIn(Logpp::Level::level)) {                          \
+            if (Logpp::IsEnabled(Logpp::Level::level)) {                                   \
+                statement;                                                                 \
+            }                                                                              \
+        }                                                                                  \
+    } while (false)
+
+#define LOGPP_LOG(logger, level, ...) \
+    LOGPP_IF_ENABLED(level, (logger).Log(Logpp::Level::level, __VA_ARGS__))
+#define LOGPP_INFO(logger, ...) LOGPP_IF_ENABLED(info, (logger).Info(__VA_ARGS__))
+#define LOGPP_ERROR(logger, ...) LOGPP_IF_ENABLED(error, (logger).Error(__VA_ARGS__))
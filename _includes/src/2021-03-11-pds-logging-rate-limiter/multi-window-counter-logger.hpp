@@ -0,0 +1,48 @@
+// multi-window-counter-logger.hpp
+
+#pragma once
+
+#include "format-logging.hpp"
+#include "logpp.hpp"
+#include "multi-window-counter.hpp"
+
+template<typename Clock, typename... Tiers>
+class BasicMultiWindowCounterLogger :
+    public FormatLogging<BasicMultiWindowCounterLogger<Clock, Tiers...>> {
+public:
+    using FormatLogging<BasicMultiWindowCounterLogger>::Info;
+    using FormatLogging<BasicMultiWindowCounterLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
+    }
+
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
+    }
+
+private:
+    friend FormatLogging<BasicMultiWindowCounterLogger>;
+
+    template<typename Message>
+    bool log(const Logpp::Level a_level, const Message &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        if (m_counter.TryAcquire()) {
+            if (m_logger.Log(a_level, MessageOf(message))) {
+                return true;
+            }
+            m_counter.Return();
+        }
+        return false;
+    }
+
+    BasicMultiWindowCounter<Clock, Tiers...> m_counter;
+    Logpp m_logger;
+};
+
+template<typename... Tiers>
+using MultiWindowCounterLogger =
+    BasicMultiWindowCounterLogger<std::chrono::steady_clock, Tiers...>;
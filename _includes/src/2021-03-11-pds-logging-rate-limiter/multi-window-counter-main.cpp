@@ -0,0 +1,8 @@
+#include "multi-window-counter-logger.hpp"
+#include "test-utils.hpp"
+
+int main() {
+    TestLimiterLogger(
+        MultiWindowCounterLogger<Tier<3, std::chrono::seconds>, Tier<20, std::chrono::minutes>,
+                                 Tier<100, std::chrono::hours>> {});
+}
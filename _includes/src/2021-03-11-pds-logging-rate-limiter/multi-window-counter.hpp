@@ -0,0 +1,74 @@
+// multi-window-counter.hpp
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "clocks.hpp"
+#include "hot-path.hpp"
+
+template<long Limit, typename Period>
+struct Tier {
+    static constexpr long LIMIT = Limit;
+    static constexpr std::int64_t PERIOD =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Period {1}).count();
+};
+
+// Sliding window counters for every tier, e.g. 100/s and 2000/min and 50000/h, sharing one
+// timestamp. A permit is admitted only when all tiers are within their limits.
+template<typename Clock, typename... Tiers>
+class BasicMultiWindowCounter {
+    static_assert(sizeof...(Tiers) > 0);
+
+public:
+    HOT_PATH bool TryAcquire() {
+        return TryAcquire(Clock::now());
+    }
+
+    bool TryAcquire(const typename Clock::time_point time_point) {
+        const auto now = NanosecondsOf<Clock>(time_point);
+
+        bool admitted = true;
+        for (std::size_t i = 0; i < TIER_COUNT; ++i) {
+            const auto offset = now % PERIODS[i];
+            const auto window = now - offset;
+            const auto same_window = window == m_windows[i];
+            const auto next_window = window == m_windows[i] + PERIODS[i];
+
+            m_last_counts[i] = same_window ? m_last_counts[i] :
+                               next_window ? m_current_counts[i] :
+                                             0;
+            m_current_counts[i] = same_window ? m_current_counts[i] : 0;
+            m_windows[i] = window;
+
+            const long count = m_last_counts[i] * (1 - double(offset) / PERIODS[i]) +
+                               m_current_counts[i];
+            admitted &= count < LIMITS[i];
+        }
+
+        for (auto &a_count : m_current_counts) {
+            a_count += admitted;
+        }
+        return admitted;
+    }
+
+    void Return() {
+        for (auto &a_count : m_current_counts) {
+            a_count -= a_count > 0;
+        }
+    }
+
+private:
+    static constexpr std::size_t TIER_COUNT = sizeof...(Tiers);
+    static constexpr std::array<std::int64_t, TIER_COUNT> PERIODS = {Tiers::PERIOD...};
+    static constexpr std::array<long, TIER_COUNT> LIMITS = {Tiers::LIMIT...};
+
+    std::array<std::int64_t, TIER_COUNT> m_windows {};
+    std::array<long, TIER_COUNT> m_last_counts {};
+    std::array<long, TIER_COUNT> m_current_counts {};
+};
+
+template<typename... Tiers>
+using MultiWindowCounter = BasicMultiWindowCounter<std::chrono::steady_clock, Tiers...>;
@@ -0,0 +1,35 @@
+// multi-window-counter.test.cpp
+
+#include <gtest/gtest.h>
+
+#include "multi-window-counter.hpp"
+
+using namespace std::chrono_literals;
+
+
+TEST(MultiWindowCounterTests, TestEveryTierMustAdmit) {
+    MultiWindowCounter<Tier<3, std::chrono::seconds>, Tier<5, std::chrono::minutes>> counter;
+    const std::chrono::steady_clock::time_point start {10min};
+
+    EXPECT_TRUE(counter.TryAcquire(start));
+    EXPECT_TRUE(counter.TryAcquire(start));
+    EXPECT_TRUE(counter.TryAcquire(start));
+    EXPECT_FALSE(counter.TryAcquire(start));
+
+    EXPECT_TRUE(counter.TryAcquire(start + 1500ms));
+    EXPECT_TRUE(counter.TryAcquire(start + 1500ms));
+    EXPECT_FALSE(counter.TryAcquire(start + 1500ms));
+
+    EXPECT_FALSE(counter.TryAcquire(start + 30s));
+    EXPECT_TRUE(counter.TryAcquire(start + 2min));
+}
+
+TEST(MultiWindowCounterTests, TestReturn) {
+    MultiWindowCounter<Tier<1, std::chrono::seconds>, Tier<1, std::chrono::hours>> counter;
+    const std::chrono::steady_clock::time_point start {1h};
+
+    EXPECT_TRUE(counter.TryAcquire(start));
+    EXPECT_FALSE(counter.TryAcquire(start + 2s));
+    counter.Return();
+    EXPECT_TRUE(counter.TryAcquire(start + 2s));
+}
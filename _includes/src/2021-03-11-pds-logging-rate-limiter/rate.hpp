@@ -4,13 +4,17 @@
 
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <stdexcept>
 
 using namespace std::chrono_literals;
 
 class Rate {
 public:
     explicit Rate(const long count, const std::chrono::seconds unit = 1s) :
-        m_count_per_second(count * 1s / unit) {
+        m_count_per_second(count * 1s / unit),
+        m_interval(m_count_per_second ? std::chrono::microseconds(1s) / m_count_per_second :
+                                        std::chrono::microseconds {0}) {
     }
 
     auto CountPerSecond() const {
@@ -19,9 +23,83 @@ public:
 
     auto Interval() const {
         assert(m_count_per_second);
-        return std::chrono::microseconds(1s) / m_count_per_second;
+        return m_interval;
     }
 
 private:
     long m_count_per_second = 0;
+    std::chrono::microseconds m_interval {0};
+};
+
+template<long Count,
+         typename Period = std::chrono::seconds,
+         long Capacity = Count * 1s / Period {1}>
+class StaticRate {
+public:
+    static constexpr long COUNT_PER_SECOND = Count * 1s / Period {1};
+    static constexpr long CAPACITY = Capacity;
+
+    static_assert(COUNT_PER_SECOND > 0 and CAPACITY > 0);
+
+    static constexpr auto CountPerSecond() {
+        return COUNT_PER_SECOND;
+    }
+
+    static constexpr auto Interval() {
+        return std::chrono::microseconds(1s) / COUNT_PER_SECOND;
+    }
+};
+
+// What a limiter needs to know about its rate: stored for a runtime Rate, and constexpr for
+// a StaticRate, so the hot paths divide only by compile-time constants.
+template<typename RateType = Rate>
+class RateLimits {
+public:
+    explicit RateLimits(const Rate &rate) : RateLimits(rate, rate.CountPerSecond()) {
+    }
+
+    RateLimits(const Rate &rate, const long capacity) :
+        m_count_per_second(rate.CountPerSecond()), m_capacity(capacity) {
+        if (m_count_per_second <= 0 or m_capacity <= 0) {
+            throw std::invalid_argument("RateLimits needs a positive rate and capacity");
+        }
+        m_interval = NANOSECONDS_PER_SECOND / m_count_per_second;
+    }
+
+    auto CountPerSecond() const {
+        return m_count_per_second;
+    }
+
+    auto Capacity() const {
+        return m_capacity;
+    }
+
+    auto IntervalNanoseconds() const {
+        return m_interval;
+    }
+
+private:
+    static constexpr std::int64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+
+    long m_count_per_second = 0;
+    long m_capacity = 0;
+    std::int64_t m_interval = 0;
+};
+
+template<long Count, typename Period, long Burst>
+class RateLimits<StaticRate<Count, Period, Burst>> {
+    using RateType = StaticRate<Count, Period, Burst>;
+
+public:
+    static constexpr long CountPerSecond() {
+        return RateType::COUNT_PER_SECOND;
+    }
+
+    static constexpr long Capacity() {
+        return RateType::CAPACITY;
+    }
+
+    static constexpr std::int64_t IntervalNanoseconds() {
+        return std::int64_t {1'000'000'000} / RateType::COUNT_PER_SECOND;
+    }
 };
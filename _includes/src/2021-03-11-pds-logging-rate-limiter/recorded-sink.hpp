@@ -0,0 +1,28 @@
+// recorded-sink.hpp
+
+#pragma once
+
+#include <chrono>
+#include <string_view>
+
+#include "flight-recorder.hpp"
+#include "logpp.hpp"
+
+// Keeps the Log calls it forwards to Sink in the installed flight recorder, if any.
+template<typename Sink = Logpp>
+class RecordedSink {
+public:
+    auto Log(const Logpp::Level a_level, const std::string_view message) const {
+        if (auto *recorder = FlightRecorder::Installed(); recorder and Logpp::IsEnabled(a_level)) {
+            recorder->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count(),
+                             static_cast<char>(a_level),
+                             message);
+        }
+        return m_sink.Log(a_level, message);
+    }
+
+private:
+    Sink m_sink;
+};
@@ -0,0 +1,208 @@
+// reloadable.hpp
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rate.hpp"
+
+// Epoch based reclamation: a reader announces the epoch it enters in a record of its own, so
+// reading never blocks, and a version retired in some epoch is freed only once every reader
+// announced an epoch at least as new, or left.
+class EpochDomain {
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::uint64_t IDLE = 0;
+
+    struct alignas(CACHE_LINE_SIZE) Record {
+        std::atomic<std::uint64_t> epoch {IDLE};
+        std::atomic<bool> in_use {true};
+    };
+
+    struct LocalRecord {
+        explicit LocalRecord(EpochDomain &domain) : record(domain.acquireRecord()) {
+        }
+
+        ~LocalRecord() {
+            record.in_use.store(false, std::memory_order_release);
+        }
+
+        Record &record;
+        unsigned depth = 0;
+    };
+
+public:
+    class Guard {
+    public:
+        explicit Guard(EpochDomain &domain) : m_local(domain.localRecord()) {
+            if (m_local.depth++ == 0) {
+                m_local.record.epoch.store(domain.m_epoch.load());
+            }
+        }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard() {
+            if (--m_local.depth == 0) {
+                m_local.record.epoch.store(IDLE, std::memory_order_release);
+            }
+        }
+
+    private:
+        LocalRecord &m_local;
+    };
+
+    static auto &Instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // Returns the epoch in which whatever was unpublished before this call is retired.
+    std::uint64_t Retire() {
+        return m_epoch.fetch_add(1) + 1;
+    }
+
+    // Everything retired up to the returned epoch is unreachable by now.
+    std::uint64_t Reclaimable() {
+        auto oldest = m_epoch.load();
+        std::lock_guard<std::mutex> guard {m_records_mutex};
+        for (const auto &a_record : m_records) {
+            if (const auto entered = a_record.epoch.load(); entered != IDLE) {
+                oldest = std::min(oldest, entered);
+            }
+        }
+        return oldest;
+    }
+
+private:
+    EpochDomain() = default;
+
+    LocalRecord &localRecord() {
+        thread_local LocalRecord local {*this};
+        return local;
+    }
+
+    Record &acquireRecord() {
+        std::lock_guard<std::mutex> guard {m_records_mutex};
+        for (auto &a_record : m_records) {
+            auto in_use = false;
+            if (a_record.in_use.compare_exchange_strong(in_use, true)) {
+                return a_record;
+            }
+        }
+        return m_records.emplace_back();
+    }
+
+    std::atomic<std::uint64_t> m_epoch {IDLE + 1};
+    std::mutex m_records_mutex;
+    std::deque<Record> m_records;
+};
+
+// A value replaced as a whole by writers, which serialize among themselves, while readers
+// keep using whichever version they loaded without ever taking a lock.
+template<typename T>
+class Reloadable {
+public:
+    class Snapshot {
+    public:
+        explicit Snapshot(const Reloadable &reloadable) :
+            m_guard(reloadable.m_domain), m_value(reloadable.m_current.load()) {
+        }
+
+        T &operator*() const {
+            return *m_value;
+        }
+
+        T *operator->() const {
+            return m_value;
+        }
+
+    private:
+        EpochDomain::Guard m_guard;
+        T *m_value = nullptr;
+    };
+
+    template<typename... Args>
+    explicit Reloadable(Args &&...args) : m_current(new T(std::forward<Args>(args)...)) {
+    }
+
+    Reloadable(const Reloadable &) = delete;
+    Reloadable &operator=(const Reloadable &) = delete;
+
+    ~Reloadable() {
+        delete m_current.load();
+    }
+
+    Snapshot Read() const {
+        return Snapshot {*this};
+    }
+
+    // Publishes make_next(current), which may close the current version in place first.
+    // Writers never wait for readers: retired versions are freed by later updates.
+    template<typename Function>
+    void Update(Function &&make_next) {
+        std::lock_guard<std::mutex> guard {m_writer_mutex};
+        auto *previous = m_current.load(std::memory_order_relaxed);
+        m_current.store(make_next(*previous).release());
+        m_retired.emplace_back(m_domain.Retire(), previous);
+
+        const auto reclaimable = m_domain.Reclaimable();
+        std::erase_if(m_retired, [reclaimable](const auto &a_retired) {
+            return a_retired.first <= reclaimable;
+        });
+    }
+
+private:
+    EpochDomain &m_domain = EpochDomain::Instance();
+    std::atomic<T *> m_current;
+    std::mutex m_writer_mutex;
+    std::vector<std::pair<std::uint64_t, std::unique_ptr<T>>> m_retired;
+};
+
+// Rate limits that another thread may replace at any time. The owner keeps its own copy and
+// polls Refresh() on the hot path, which costs one load until a new version is stored.
+class ReloadableLimits {
+public:
+    struct Version {
+        RateLimits<> limits;
+        std::uint64_t number = 0;
+    };
+
+    template<typename... Args>
+    explicit ReloadableLimits(const Args &...args) :
+        m_versions(Version {RateLimits<> {args...}}) {
+    }
+
+    template<typename... Args>
+    void Store(const Args &...args) {
+        const RateLimits<> limits {args...};
+        m_versions.Update([this, &limits](const Version &) {
+            return std::make_unique<Version>(
+                Version {limits, m_number.fetch_add(1, std::memory_order_relaxed) + 1});
+        });
+    }
+
+    Version Load() const {
+        return *m_versions.Read();
+    }
+
+    bool Refresh(Version &seen) const {
+        if (m_number.load(std::memory_order_acquire) == seen.number) {
+            return false;
+        }
+
+        seen = Load();
+        return true;
+    }
+
+private:
+    Reloadable<Version> m_versions;
+    std::atomic<std::uint64_t> m_number {0};
+};
@@ -0,0 +1,137 @@
+// reloadable.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "clocks.hpp"
+#include "gcra.hpp"
+#include "reloadable.hpp"
+#include "sliding-log-logger.hpp"
+
+
+static constexpr auto THREAD_COUNT = 32;
+static constexpr auto RELOAD_PERIOD = 100us;
+static constexpr auto DURATION = 200ms;
+
+// Calls reload(i) at 10 kHz while THREAD_COUNT threads call their own copies of hammer().
+template<typename Reload, typename Hammer>
+static auto reloadWhileHammering(Reload &&reload, const Hammer &hammer) {
+    std::atomic<bool> done {false};
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&done, a_hammer = hammer]() mutable {
+            while (not done.load(std::memory_order_relaxed)) {
+                a_hammer();
+            }
+        });
+    }
+
+    long reloads = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto next = start; std::chrono::steady_clock::now() - start < DURATION;
+         next += RELOAD_PERIOD) {
+        std::this_thread::sleep_until(next);
+        reload(reloads++);
+    }
+
+    done = true;
+    for (auto &a_thread : threads) {
+        a_thread.join();
+    }
+    return reloads;
+}
+
+
+TEST(ReloadableTests, TestReadersNeverSeeTornLimits) {
+    ReloadableLimits limits {Rate {1}, 2};
+    std::atomic<long> torn {0};
+
+    const auto reloads = reloadWhileHammering(
+        [&limits](const long i) {
+            limits.Store(Rate {i + 1}, 2 * (i + 1));
+        },
+        [&limits, &torn, seen = limits.Load()]() mutable {
+            if (limits.Refresh(seen) and
+                seen.limits.Capacity() != 2 * seen.limits.CountPerSecond()) {
+                ++torn;
+            }
+        });
+
+    EXPECT_GT(reloads, 0);
+    EXPECT_EQ(0, torn.load());
+    EXPECT_EQ(reloads, limits.Load().limits.CountPerSecond());
+}
+
+TEST(ReloadableTests, TestGcraReloadLosesNoPermits) {
+    constexpr long CAPACITY = 1'000;
+
+    ManualClock::Reset(1s);
+    ReloadableGcraLimiter<ManualClock> limiter {Rate {1'000}, CAPACITY};
+    std::atomic<long> granted {0};
+
+    const auto reloads = reloadWhileHammering(
+        [&limiter, CAPACITY](const long i) {
+            limiter.Reload(Rate {i % 2 ? 1'000 : 3'000}, CAPACITY);
+        },
+        [&limiter, &granted] {
+            if (limiter.FetchToken()) {
+                ++granted;
+            }
+        });
+
+    EXPECT_GT(reloads, 0);
+    EXPECT_EQ(CAPACITY, granted.load());
+}
+
+TEST(ReloadableTests, TestGcraReloadKeepsShareOfCapacity) {
+    ManualClock::Reset(1s);
+    ReloadableGcraLimiter<ManualClock> limiter {Rate {100}};
+
+    for (auto i = 0; i < 40; ++i) {
+        ASSERT_TRUE(limiter.FetchToken());
+    }
+    limiter.Reload(Rate {100}, 50);
+
+    long granted = 0;
+    while (limiter.FetchToken()) {
+        ++granted;
+    }
+    EXPECT_EQ(30, granted);
+
+    limiter.Return();
+    EXPECT_TRUE(limiter.FetchToken());
+}
+
+class NullSink {
+public:
+    bool Log(const Logpp::Level, const std::string_view) const {
+        return true;
+    }
+};
+
+TEST(ReloadableTests, TestSlidingLogReloadKeepsLoggedEntries) {
+    ManualClock::Reset(1s);
+    SlidingLogLogger<ManualClock, NullSink> logger {4};
+
+    for (auto i = 0; i < 2; ++i) {
+        ASSERT_TRUE(logger.Info(""));
+        ManualClock::Advance(100ms);
+    }
+
+    logger.SetRate(2);
+    EXPECT_TRUE(logger.Info(""));
+    EXPECT_FALSE(logger.Info(""));
+
+    logger.SetRate(6);
+    for (auto i = 0; i < 4; ++i) {
+        EXPECT_TRUE(logger.Info("")) << i;
+    }
+    EXPECT_FALSE(logger.Info(""));
+
+    ManualClock::Advance(901ms);
+    EXPECT_TRUE(logger.Info(""));
+}
@@ -0,0 +1,60 @@
+// segmented-file-log.bench.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "segmented-file-log.hpp"
+
+constexpr std::size_t LINE_SIZE = 128;
+
+SegmentSettings BenchSettings(const Durability durability) {
+    SegmentSettings settings;
+    settings.directory = std::filesystem::temp_directory_path() /
+                         ("segmented-file-log.bench." + std::to_string(::getpid()));
+    settings.durability = durability;
+    std::filesystem::create_directories(settings.directory);
+    return settings;
+}
+
+// Producers spin while the buffer is full, so this is the rate the writer sustains.
+static void BM_SegmentedFileLog(benchmark::State &state) {
+    const auto settings = BenchSettings(static_cast<Durability>(state.range(0)));
+    const auto line = std::string(LINE_SIZE - 1, 'x') + '\n';
+    {
+        SegmentedFileLog log {settings};
+        for (auto _ : state) {
+            while (not log.Append(line)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::filesystem::remove_all(settings.directory);
+    state.SetBytesProcessed(state.iterations() * LINE_SIZE);
+}
+
+BENCHMARK(BM_SegmentedFileLog)
+    ->Arg(static_cast<int>(Durability::none))
+    ->Arg(static_cast<int>(Durability::periodic))
+    ->Arg(static_cast<int>(Durability::per_batch))
+    ->UseRealTime();
+
+static void BM_Ofstream(benchmark::State &state) {
+    const auto settings = BenchSettings(Durability::none);
+    const auto line = std::string(LINE_SIZE - 1, 'x') + '\n';
+    {
+        std::ofstream out {settings.directory / "ofstream.log"};
+        for (auto _ : state) {
+            out << line;
+        }
+    }
+
+    std::filesystem::remove_all(settings.directory);
+    state.SetBytesProcessed(state.iterations() * LINE_SIZE);
+}
+
+BENCHMARK(BM_Ofstream)->UseRealTime();
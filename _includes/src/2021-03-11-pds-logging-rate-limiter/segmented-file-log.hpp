@@ -0,0 +1,349 @@
+// segmented-file-log.hpp
+
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "current-instance.hpp"
+#include "logpp.hpp"
+#include "shutdown-registry.hpp"
+
+enum class Durability {
+    none,
+    periodic,
+    per_batch,
+};
+
+struct SegmentSettings {
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string prefix = "logpp";
+    std::size_t segment_size = std::size_t {64} << 20;
+    std::chrono::nanoseconds segment_age = std::chrono::hours {1};
+    Durability durability = Durability::periodic;
+    std::chrono::nanoseconds batch_period = std::chrono::milliseconds {1};
+    std::chrono::nanoseconds sync_period = std::chrono::milliseconds {100};
+    std::size_t buffer_size = std::size_t {1} << 20;
+};
+
+// Producers append lines to a buffer, which a background thread writes in batches into
+// segment files preallocated up front. Every write covers whole blocks at a block aligned
+// offset, the last block padded with zeros and rewritten by the next batch, so a segment reads
+// as its lines up to the first zero byte. A full buffer drops the line instead of stalling
+// the producer, and a failed write drops its batch, which Errors() and LostBytes() count. A
+// segment that cannot be opened is counted too, and the lines go on into the current one.
+class SegmentedFileLog {
+public:
+    static constexpr std::size_t BLOCK_SIZE = 4096;
+
+    explicit SegmentedFileLog(SegmentSettings settings) :
+        m_settings(std::move(settings)),
+        m_staging(static_cast<char *>(std::aligned_alloc(
+            BLOCK_SIZE, roundUp(m_settings.buffer_size) + BLOCK_SIZE))) {
+        m_pending.reserve(m_settings.buffer_size);
+        m_batch.reserve(m_settings.buffer_size);
+
+        const auto segments = Segments(m_settings);
+        if (not segments.empty()) {
+            m_index = *indexOf(segments.back(), m_settings) + 1;
+        }
+        if (not openSegment()) {
+            const auto error = errno;
+            throw std::system_error(error, std::system_category(), segmentPath().string());
+        }
+
+        m_thread = std::thread {[this] {
+            run();
+        }};
+        Current::Install(*this);
+        m_shutdown = ShutdownRegistry::Instance().Register(ShutdownRegistry::SINK_PRIORITY, [this] {
+            Flush();
+        });
+    }
+
+    SegmentedFileLog(const SegmentedFileLog &) = delete;
+    SegmentedFileLog &operator=(const SegmentedFileLog &) = delete;
+
+    ~SegmentedFileLog() {
+        ShutdownRegistry::Instance().Unregister(m_shutdown);
+        Current::Uninstall(*this);
+        {
+            std::lock_guard<std::mutex> guard {m_stop_mutex};
+            m_stop = true;
+        }
+        m_stop_cv.notify_one();
+        m_thread.join();
+
+        std::lock_guard<std::mutex> guard {m_write_mutex};
+        writeBatch();
+        closeSegment();
+    }
+
+    // Writes out the buffered lines and syncs them, unless the durability is none.
+    void Flush() {
+        std::lock_guard<std::mutex> guard {m_write_mutex};
+        writeBatch();
+        if (m_settings.durability != Durability::none) {
+            check(::fdatasync(m_fd) == 0);
+        }
+    }
+
+    // The log that FileLogpp appends to, if any.
+    using Current = CurrentInstance<SegmentedFileLog>;
+
+    // The number of opens, writes, syncs, preallocations and truncations that failed so far.
+    std::size_t Errors() const {
+        return m_errors.load(std::memory_order_relaxed);
+    }
+
+    // The bytes of the batches dropped by failed writes so far.
+    std::size_t LostBytes() const {
+        return m_lost_bytes.load(std::memory_order_relaxed);
+    }
+
+    bool Append(const std::string_view line) {
+        std::lock_guard<std::mutex> guard {m_pending_mutex};
+        if (m_pending.size() + line.size() > m_settings.buffer_size) {
+            return false;
+        }
+
+        m_pending.append(line);
+        return true;
+    }
+
+    // The segments in the directory, in the order they were written. Files that are not named
+    // like a segment are left alone.
+    static std::vector<std::filesystem::path> Segments(const SegmentSettings &settings) {
+        std::vector<std::filesystem::path> segments;
+        for (const auto &an_entry : std::filesystem::directory_iterator {settings.directory}) {
+            if (indexOf(an_entry.path(), settings)) {
+                segments.push_back(an_entry.path());
+            }
+        }
+        std::sort(segments.begin(), segments.end(), [&settings](const auto &a, const auto &b) {
+            return *indexOf(a, settings) < *indexOf(b, settings);
+        });
+        return segments;
+    }
+
+    static std::string ReadSegment(const std::filesystem::path &path) {
+        std::ifstream in {path, std::ios::binary};
+        std::string content {std::istreambuf_iterator<char> {in}, {}};
+        content.resize(std::min(content.size(), content.find('\0')));
+        return content;
+    }
+
+private:
+    struct Free {
+        void operator()(char *memory) const {
+            std::free(memory);
+        }
+    };
+
+    static std::size_t roundUp(const std::size_t size) {
+        return (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    }
+
+    // The index of a file named prefix-<digits>.log, if it is one.
+    static std::optional<std::size_t> indexOf(const std::filesystem::path &path,
+                                              const SegmentSettings &settings) {
+        const auto name = path.filename().string();
+        if (not name.starts_with(settings.prefix + '-') or not name.ends_with(".log") or
+            name.size() <= settings.prefix.size() + 5) {
+            return std::nullopt;
+        }
+
+        const auto *first = name.data() + settings.prefix.size() + 1;
+        const auto *last = name.data() + name.size() - 4;
+        std::size_t index = 0;
+        const auto result = std::from_chars(first, last, index);
+        if (result.ec != std::errc {} or result.ptr != last) {
+            return std::nullopt;
+        }
+        return index;
+    }
+
+    void check(const bool succeeded) {
+        if (not succeeded) {
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::filesystem::path segmentPath() const {
+        std::ostringstream name;
+        name << m_settings.prefix << '-' << std::setw(6) << std::setfill('0') << m_index
+             << ".log";
+        return m_settings.directory / name.str();
+    }
+
+    // Keeps the current segment, if any, when the next one cannot be opened.
+    bool openSegment() {
+        const auto path = segmentPath();
+        const auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+
+        if (m_fd >= 0) {
+            closeSegment();
+        }
+        m_fd = fd;
+        check(::posix_fallocate(m_fd, 0, static_cast<off_t>(m_settings.segment_size)) == 0);
+        m_opened = std::chrono::steady_clock::now();
+        m_block_offset = 0;
+        m_staged = 0;
+        ++m_index;
+        return true;
+    }
+
+    // Trims the preallocated space, so a finished segment holds nothing but its lines.
+    void closeSegment() {
+        if (m_settings.durability != Durability::none) {
+            check(::fdatasync(m_fd) == 0);
+        }
+        check(::ftruncate(m_fd, static_cast<off_t>(m_block_offset + m_staged)) == 0);
+        ::close(m_fd);
+    }
+
+    void writeBatch() {
+        {
+            std::lock_guard<std::mutex> guard {m_pending_mutex};
+            m_batch.swap(m_pending);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto size = m_block_offset + m_staged;
+        if (size and (size + m_batch.size() > m_settings.segment_size or
+                      now - m_opened >= m_settings.segment_age)) {
+            if (not openSegment()) {
+                check(false);
+                m_opened = now;
+            }
+        }
+
+        if (not m_batch.empty()) {
+            writeBlocks();
+            m_batch.clear();
+            m_unsynced = true;
+        }
+
+        if (m_unsynced and (m_settings.durability == Durability::per_batch or
+                            (m_settings.durability == Durability::periodic and
+                             now >= m_next_sync))) {
+            check(::fdatasync(m_fd) == 0);
+            m_unsynced = false;
+            m_next_sync = now + m_settings.sync_period;
+        }
+    }
+
+    // Drops the batch if it cannot be written, and keeps the blocks written before it, so the
+    // next batch goes where this one should have.
+    void writeBlocks() {
+        std::memcpy(m_staging.get() + m_staged, m_batch.data(), m_batch.size());
+        const auto staged = m_staged + m_batch.size();
+        const auto size = roundUp(staged);
+        std::memset(m_staging.get() + staged, 0, size - staged);
+
+        for (std::size_t written = 0; written < size;) {
+            const auto result = ::pwrite(m_fd,
+                                         m_staging.get() + written,
+                                         size - written,
+                                         static_cast<off_t>(m_block_offset + written));
+            if (result < 0 and errno != EINTR) {
+                check(false);
+                m_lost_bytes.fetch_add(m_batch.size(), std::memory_order_relaxed);
+                return;
+            }
+            written += static_cast<std::size_t>(std::max<ssize_t>(result, 0));
+        }
+
+        m_staged = staged;
+        const auto full = m_staged / BLOCK_SIZE * BLOCK_SIZE;
+        std::memmove(m_staging.get(), m_staging.get() + full, m_staged - full);
+        m_block_offset += full;
+        m_staged -= full;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock {m_stop_mutex};
+        while (not m_stop_cv.wait_for(lock, m_settings.batch_period, [this] {
+            return m_stop;
+        })) {
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> guard {m_write_mutex};
+                writeBatch();
+            }
+            lock.lock();
+        }
+    }
+
+    const SegmentSettings m_settings;
+
+    std::mutex m_pending_mutex;
+    std::string m_pending;
+
+    std::mutex m_write_mutex;
+    std::string m_batch;
+    std::unique_ptr<char, Free> m_staging;
+    std::size_t m_staged = 0;
+    std::size_t m_block_offset = 0;
+    std::size_t m_index = 0;
+    int m_fd = -1;
+    std::chrono::steady_clock::time_point m_opened;
+    std::chrono::steady_clock::time_point m_next_sync;
+    bool m_unsynced = false;
+    std::atomic<std::size_t> m_errors {0};
+    std::atomic<std::size_t> m_lost_bytes {0};
+
+    std::mutex m_stop_mutex;
+    std::condition_variable m_stop_cv;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    ShutdownRegistry::Id m_shutdown = 0;
+};
+
+// A sink for the limiter loggers that writes Logpp lines to the current SegmentedFileLog.
+class FileLogpp {
+public:
+    bool Log(const Logpp::Level a_level, const std::string_view message) const {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        const auto log = SegmentedFileLog::Current::Acquire();
+        if (not log) {
+            return false;
+        }
+
+        const auto now = std::chrono::system_clock::now();
+
+        thread_local std::ostringstream line;
+        line.str({});
+        Logpp::Format(line, now, a_level, message) << '\n';
+        return log->Append(line.view());
+    }
+};
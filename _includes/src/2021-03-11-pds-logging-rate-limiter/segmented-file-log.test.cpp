@@ -0,0 +1,204 @@
+// segmented-file-log.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "segmented-file-log.hpp"
+#include "token-bucket-logger.hpp"
+
+
+class SegmentedFileLogTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto *test = ::testing::UnitTest::GetInstance()->current_test_info();
+        m_settings.directory = std::filesystem::temp_directory_path() /
+                               (std::string {"segmented-file-log."} + test->name() + '.' +
+                                std::to_string(::getpid()));
+        std::filesystem::create_directories(m_settings.directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_settings.directory);
+    }
+
+    std::vector<std::string> readLines() const {
+        std::string content;
+        for (const auto &a_segment : SegmentedFileLog::Segments(m_settings)) {
+            content += SegmentedFileLog::ReadSegment(a_segment);
+        }
+
+        std::vector<std::string> lines;
+        std::istringstream in {content};
+        for (std::string a_line; std::getline(in, a_line);) {
+            lines.push_back(a_line);
+        }
+        if (not content.empty() and content.back() != '\n') {
+            lines.back() += '~';
+        }
+        return lines;
+    }
+
+    static void appendLines(SegmentedFileLog &log, const int from, const int to) {
+        for (auto i = from; i < to; ++i) {
+            const auto line = "line " + std::to_string(i) + '\n';
+            while (not log.Append(line)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    static std::vector<std::string> expectedLines(const int to) {
+        std::vector<std::string> lines;
+        for (auto i = 0; i < to; ++i) {
+            lines.push_back("line " + std::to_string(i));
+        }
+        return lines;
+    }
+
+    SegmentSettings m_settings;
+};
+
+TEST_F(SegmentedFileLogTests, TestRotatesBySize) {
+    constexpr auto LINES = 5000;
+    m_settings.segment_size = 4 * SegmentedFileLog::BLOCK_SIZE;
+    m_settings.buffer_size = SegmentedFileLog::BLOCK_SIZE;
+    {
+        SegmentedFileLog log {m_settings};
+        appendLines(log, 0, LINES);
+    }
+
+    const auto segments = SegmentedFileLog::Segments(m_settings);
+    EXPECT_LT(1, segments.size());
+    for (const auto &a_segment : segments) {
+        EXPECT_GE(m_settings.segment_size, std::filesystem::file_size(a_segment));
+    }
+    EXPECT_EQ(expectedLines(LINES), readLines());
+}
+
+TEST_F(SegmentedFileLogTests, TestRotatesByAge) {
+    m_settings.segment_age = 1ms;
+    {
+        SegmentedFileLog log {m_settings};
+        appendLines(log, 0, 1);
+        log.Flush();
+        std::this_thread::sleep_for(20ms);
+        appendLines(log, 1, 2);
+    }
+
+    EXPECT_EQ(2, SegmentedFileLog::Segments(m_settings).size());
+    EXPECT_EQ(expectedLines(2), readLines());
+}
+
+TEST_F(SegmentedFileLogTests, TestKeepsSegmentWhenNextCannotOpen) {
+    m_settings.segment_age = 1ms;
+    const auto next = m_settings.directory / (m_settings.prefix + "-000001.log");
+    {
+        SegmentedFileLog log {m_settings};
+        std::filesystem::create_directory(next);
+        appendLines(log, 0, 1);
+        log.Flush();
+        std::this_thread::sleep_for(20ms);
+        appendLines(log, 1, 2);
+        log.Flush();
+
+        EXPECT_LT(0, log.Errors());
+        EXPECT_EQ(0, log.LostBytes());
+    }
+
+    std::filesystem::remove(next);
+    EXPECT_EQ(expectedLines(2), readLines());
+}
+
+TEST_F(SegmentedFileLogTests, TestContinuesAfterExistingSegments) {
+    for (const auto *a_name : {"logpp-old.log", "logpp-.log", "logpp-1x.log", "logpp-99.txt"}) {
+        std::ofstream {m_settings.directory / a_name} << "not a segment\n";
+    }
+
+    for (auto i = 0; i < 2; ++i) {
+        SegmentedFileLog log {m_settings};
+        appendLines(log, i, i + 1);
+        log.Flush();
+        EXPECT_EQ(0, log.Errors());
+        EXPECT_EQ(0, log.LostBytes());
+    }
+
+    EXPECT_EQ(2, SegmentedFileLog::Segments(m_settings).size());
+    EXPECT_EQ(expectedLines(2), readLines());
+}
+
+TEST_F(SegmentedFileLogTests, TestSurvivesKilledWriter) {
+    m_settings.segment_size = 16 * SegmentedFileLog::BLOCK_SIZE;
+    m_settings.durability = Durability::per_batch;
+
+    const auto child = ::fork();
+    ASSERT_LE(0, child);
+    if (child == 0) {
+        SegmentedFileLog log {m_settings};
+        appendLines(log, 0, std::numeric_limits<int>::max());
+    }
+
+    while (SegmentedFileLog::Segments(m_settings).size() < 3) {
+        std::this_thread::sleep_for(1ms);
+    }
+    ::kill(child, SIGKILL);
+    ::waitpid(child, nullptr, 0);
+
+    auto lines = readLines();
+    ASSERT_LT(0, lines.size());
+    if (lines.back().ends_with('~')) {
+        const auto torn = lines.back().substr(0, lines.back().size() - 1);
+        lines.pop_back();
+        EXPECT_TRUE(("line " + std::to_string(lines.size())).starts_with(torn)) << torn;
+    }
+    EXPECT_EQ(expectedLines(static_cast<int>(lines.size())), lines);
+}
+
+TEST_F(SegmentedFileLogTests, TestFileSinkNeedsCurrentLog) {
+    TokenBucketLogger<std::chrono::steady_clock, FileLogpp> logger {3};
+    EXPECT_FALSE(logger.Info("dropped"));
+
+    {
+        SegmentedFileLog log {m_settings};
+        EXPECT_TRUE(logger.Info("written"));
+    }
+
+    const auto lines = readLines();
+    ASSERT_EQ(1, lines.size());
+    EXPECT_TRUE(lines.front().ends_with("(I) written")) << lines.front();
+}
+
+TEST_F(SegmentedFileLogTests, TestFileSinkOutlivesLog) {
+    constexpr auto THREADS = 4;
+    constexpr auto LOGS = 20;
+    std::atomic<bool> stop {false};
+
+    std::vector<std::jthread> threads;
+    for (auto i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&stop] {
+            const FileLogpp sink;
+            while (not stop.load(std::memory_order_relaxed)) {
+                sink.Log(Logpp::Level::info, "racing");
+            }
+        });
+    }
+
+    for (auto i = 0; i < LOGS; ++i) {
+        SegmentedFileLog log {m_settings};
+        std::this_thread::sleep_for(1ms);
+    }
+    stop = true;
+    threads.clear();
+
+    for (const auto &a_line : readLines()) {
+        EXPECT_TRUE(a_line.ends_with("(I) racing")) << a_line;
+    }
+}
@@ -0,0 +1,144 @@
+// sharded-token-bucket.hpp
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "clocks.hpp"
+#include "hot-path.hpp"
+#include "rate.hpp"
+
+// Every shard keeps a local budget of at most `batch` permits, taken from the global
+// bucket, on its own cache line. Budgets left in the shards are handed back to the global
+// bucket whenever it refills, so within any period t at most
+// capacity + rate * t + MaxOvershoot() permits are granted.
+template<typename Clock = std::chrono::steady_clock, typename RateType = Rate>
+class ShardedTokenBucketLimiter {
+public:
+    explicit ShardedTokenBucketLimiter(const Rate &rate) :
+        ShardedTokenBucketLimiter(RateLimits<RateType> {rate}) {
+    }
+
+    ShardedTokenBucketLimiter(const Rate &rate,
+                              const long capacity,
+                              const std::size_t shard_count = DefaultShardCount()) :
+        ShardedTokenBucketLimiter(RateLimits<RateType> {rate, capacity}, shard_count) {
+    }
+
+    explicit ShardedTokenBucketLimiter(const RateLimits<RateType> &limits = {},
+                                       const std::size_t shard_count = DefaultShardCount()) :
+        m_limits(limits),
+        m_batch(std::max(1L, m_limits.Capacity() /
+                                 static_cast<long>(2 * std::bit_ceil(shard_count)))),
+        m_max_elapsed((m_limits.Capacity() / m_limits.CountPerSecond() + 1) *
+                      NANOSECONDS_PER_SECOND),
+        m_shards(std::bit_ceil(shard_count)) {
+    }
+
+    HOT_PATH bool FetchToken() {
+        auto &shard = localShard();
+        auto tokens = shard.tokens.load(std::memory_order_relaxed);
+        while (tokens > 0) {
+            if (shard.tokens.compare_exchange_weak(tokens, tokens - 1,
+                                                   std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return refillShard(shard);
+    }
+
+    void Return() {
+        localShard().tokens.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    long MaxOvershoot() const {
+        return m_batch * m_shards.size();
+    }
+
+    static std::size_t DefaultShardCount() {
+        return std::max(1U, std::thread::hardware_concurrency());
+    }
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::int64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+    static constexpr std::int64_t REBALANCE_PERIOD = 1'000'000;
+
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<long> tokens {0};
+    };
+
+    static std::int64_t now() {
+        return NanosecondsOf<Clock>(Clock::now());
+    }
+
+    static std::size_t threadIndex() {
+        static std::atomic<std::size_t> next_index {0};
+        thread_local const auto index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    Shard &localShard() {
+        return m_shards[threadIndex() & (m_shards.size() - 1)];
+    }
+
+    bool refillShard(Shard &shard) {
+        refillGlobal();
+
+        auto global = m_global.load(std::memory_order_relaxed);
+        while (global > 0) {
+            const auto grant = std::min(global, m_batch);
+            if (m_global.compare_exchange_weak(global, global - grant,
+                                               std::memory_order_relaxed)) {
+                shard.tokens.fetch_add(grant - 1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void refillGlobal() {
+        const auto current = now();
+        auto last = m_last_refill.load(std::memory_order_relaxed);
+        const auto elapsed = current - last;
+        const auto refill = std::min(elapsed, m_max_elapsed) * m_limits.CountPerSecond() /
+                            NANOSECONDS_PER_SECOND;
+        if (elapsed < REBALANCE_PERIOD or refill < 1) {
+            return;
+        }
+
+        const auto consumed = refill * NANOSECONDS_PER_SECOND / m_limits.CountPerSecond();
+        const auto next = elapsed > m_max_elapsed ? current : last + consumed;
+        if (not m_last_refill.compare_exchange_strong(last, next, std::memory_order_relaxed)) {
+            return;
+        }
+
+        auto tokens = refill;
+        for (auto &a_shard : m_shards) {
+            tokens += a_shard.tokens.exchange(0, std::memory_order_relaxed);
+        }
+
+        const auto capacity = m_limits.Capacity();
+        auto global = m_global.load(std::memory_order_relaxed);
+        while (not m_global.compare_exchange_weak(global, std::min(capacity, global + tokens),
+                                                  std::memory_order_relaxed)) {
+        }
+    }
+
+    [[no_unique_address]] const RateLimits<RateType> m_limits;
+    const long m_batch = 1;
+    const std::int64_t m_max_elapsed = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<long> m_global {m_limits.Capacity()};
+    std::atomic<std::int64_t> m_last_refill {now()};
+
+    std::vector<Shard> m_shards;
+};
@@ -0,0 +1,58 @@
+// sharded-token-bucket.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "sharded-token-bucket.hpp"
+
+
+TEST(ShardedTokenBucketLimiterTests, TestGrantsCapacityUpFront) {
+    ShardedTokenBucketLimiter limiter {Rate {1}, 100, 4};
+
+    long granted = 0;
+    while (limiter.FetchToken()) {
+        ++granted;
+    }
+
+    EXPECT_EQ(100, granted);
+}
+
+TEST(ShardedTokenBucketLimiterTests, TestReturnedTokenIsReused) {
+    ShardedTokenBucketLimiter limiter {Rate {1}, 1, 4};
+
+    EXPECT_TRUE(limiter.FetchToken());
+    EXPECT_FALSE(limiter.FetchToken());
+    limiter.Return();
+    EXPECT_TRUE(limiter.FetchToken());
+}
+
+TEST(ShardedTokenBucketLimiterTests, TestOvershootIsBounded) {
+    constexpr long RATE = 100'000;
+    constexpr long CAPACITY = 1'000;
+    constexpr auto THREAD_COUNT = 16;
+    constexpr auto DURATION = 200ms;
+
+    ShardedTokenBucketLimiter limiter {Rate {RATE}, CAPACITY, 8};
+    std::atomic<long> granted {0};
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&limiter, &granted, start, DURATION] {
+            long local_granted = 0;
+            while (std::chrono::steady_clock::now() - start < DURATION) {
+                local_granted += limiter.FetchToken() ? 1 : 0;
+            }
+            granted += local_granted;
+        });
+    }
+    for (auto &a_thread : threads) {
+        a_thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GE(granted.load(), CAPACITY);
+    EXPECT_LE(granted.load(), CAPACITY + RATE * elapsed.count() + limiter.MaxOvershoot());
+}
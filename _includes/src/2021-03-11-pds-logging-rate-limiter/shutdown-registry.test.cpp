@@ -0,0 +1,203 @@
+// shutdown-registry.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "flush-on-shutdown.hpp"
+#include "leaky-bucket-logger.hpp"
+#include "shutdown-registry.hpp"
+
+
+TEST(ShutdownRegistryTests, TestRunsOnceByPriority) {
+    ShutdownRegistry registry;
+    std::vector<int> order;
+    registry.Register(ShutdownRegistry::SINK_PRIORITY, [&order] {
+        order.push_back(1);
+    });
+    registry.Register(ShutdownRegistry::QUEUE_PRIORITY, [&order] {
+        order.push_back(2);
+    });
+    const auto id = registry.Register(ShutdownRegistry::QUEUE_PRIORITY, [&order] {
+        order.push_back(3);
+    });
+    registry.Unregister(id);
+
+    EXPECT_EQ(2, registry.Run());
+    EXPECT_EQ(0, registry.Run());
+    EXPECT_EQ((std::vector<int> {2, 1}), order);
+}
+
+TEST(ShutdownRegistryTests, TestUnregisterWaitsForRunningCallback) {
+    ShutdownRegistry registry;
+    std::atomic<bool> started {false};
+    std::atomic<bool> finished {false};
+    const auto id = registry.Register(ShutdownRegistry::SINK_PRIORITY, [&started, &finished] {
+        started = true;
+        std::this_thread::sleep_for(50ms);
+        finished = true;
+    });
+    std::thread runner {[&registry] {
+        registry.Run();
+    }};
+    while (not started) {
+        std::this_thread::yield();
+    }
+
+    registry.Unregister(id);
+    EXPECT_TRUE(finished);
+    runner.join();
+}
+
+TEST(ShutdownRegistryTests, TestCallbackMayUnregisterItself) {
+    ShutdownRegistry registry;
+    ShutdownRegistry::Id id = 0;
+    id = registry.Register(ShutdownRegistry::SINK_PRIORITY, [&registry, &id] {
+        registry.Unregister(id);
+    });
+
+    EXPECT_EQ(1, registry.Run());
+}
+
+TEST(ShutdownRegistryTests, TestSkipsCallbackUnregisteredByEarlierOne) {
+    ShutdownRegistry registry;
+    auto ran = false;
+    const auto id = registry.Register(ShutdownRegistry::SINK_PRIORITY, [&ran] {
+        ran = true;
+    });
+    registry.Register(ShutdownRegistry::QUEUE_PRIORITY, [&registry, id] {
+        registry.Unregister(id);
+    });
+
+    EXPECT_EQ(1, registry.Run());
+    EXPECT_FALSE(ran);
+}
+
+TEST(ShutdownRegistryTests, TestExitsWhenCallbackOverrunsDeadline) {
+    EXPECT_EXIT(
+        {
+            ShutdownRegistry registry;
+            registry.Register(
+                ShutdownRegistry::SINK_PRIORITY,
+                [] {
+                    std::this_thread::sleep_for(10s);
+                },
+                100ms);
+            registry.Run();
+            std::exit(EXIT_SUCCESS);
+        },
+        ::testing::ExitedWithCode(EXIT_FAILURE),
+        "");
+}
+
+TEST(ShutdownRegistryTests, TestExitsWhenBudgetRunsOut) {
+    EXPECT_EXIT(
+        {
+            ShutdownRegistry registry;
+            registry.SetBudget(200ms);
+            for (auto i = 0; i < 3; ++i) {
+                registry.Register(ShutdownRegistry::SINK_PRIORITY, [] {
+                    std::this_thread::sleep_for(90ms);
+                });
+            }
+            registry.Run();
+            std::exit(EXIT_SUCCESS);
+        },
+        ::testing::ExitedWithCode(EXIT_FAILURE),
+        "");
+}
+
+class ShutdownRegistryExitTests : public ::testing::Test {
+protected:
+    // Runs how_to_end in a child that registered a flush, and returns its wait status.
+    template<typename HowToEnd>
+    int endChild(const HowToEnd &how_to_end) const {
+        const auto child = ::fork();
+        if (child == 0) {
+            ShutdownRegistry::Instance().Register(ShutdownRegistry::SINK_PRIORITY, [this] {
+                std::ofstream {m_path} << "flushed";
+            });
+            how_to_end();
+        }
+
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        return status;
+    }
+
+    std::string flushed() const {
+        std::ifstream in {m_path};
+        return std::string {std::istreambuf_iterator<char> {in}, {}};
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(m_path);
+    }
+
+    const std::filesystem::path m_path =
+        std::filesystem::temp_directory_path() /
+        ("shutdown-registry." + std::to_string(::getpid()) + ".flushed");
+};
+
+TEST_F(ShutdownRegistryExitTests, TestFlushesOnExit) {
+    const auto status = endChild([] {
+        std::exit(3);
+    });
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(3, WEXITSTATUS(status));
+    EXPECT_EQ("flushed", flushed());
+}
+
+TEST_F(ShutdownRegistryExitTests, TestFlushesOnTerminate) {
+    const auto status = endChild([] {
+        std::terminate();
+    });
+    ASSERT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(SIGABRT, WTERMSIG(status));
+    EXPECT_EQ("flushed", flushed());
+}
+
+TEST_F(ShutdownRegistryExitTests, TestFlushesWrappedLoggerOnExit) {
+    static_assert(not std::is_copy_constructible_v<FlushOnShutdown<LeakyBucketLogger>>);
+
+    const auto log_path = m_path.string() + ".log";
+    const auto status = endChild([&log_path] {
+        std::ofstream out {log_path};
+        std::cout.rdbuf(out.rdbuf());
+        FlushOnShutdown<LeakyBucketLogger, ShutdownRegistry::QUEUE_PRIORITY> logger {10};
+        logger.Info("queued");
+        std::exit(EXIT_SUCCESS);
+    });
+    ASSERT_TRUE(WIFEXITED(status));
+
+    std::ifstream in {log_path};
+    const std::string lines {std::istreambuf_iterator<char> {in}, {}};
+    std::filesystem::remove(log_path);
+    EXPECT_NE(std::string::npos, lines.find("(I) queued\n")) << lines;
+}
+
+TEST(LeakyBucketShutdownTests, TestFlushesQueueOnDestruction) {
+    std::ostringstream out;
+    auto *original = std::cout.rdbuf(out.rdbuf());
+    {
+        LeakyBucketLogger logger {10};
+        logger.Info("first");
+        logger.Error("second");
+    }
+    std::cout.rdbuf(original);
+
+    const auto lines = out.str();
+    EXPECT_NE(std::string::npos, lines.find("(I) first\n")) << lines;
+    EXPECT_NE(std::string::npos, lines.find("(E) second\n")) << lines;
+}
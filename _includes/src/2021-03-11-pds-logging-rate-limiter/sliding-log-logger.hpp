@@ -3,53 +3,89 @@
 #pragma once
 
 #include <chrono>
-#include <queue>
+#include <deque>
 
+#include "format-logging.hpp"
 #include "logpp.hpp"
 #include "rate.hpp"
+#include "reloadable.hpp"
 
-class SlidingLogLogger {
+template<typename Clock = std::chrono::steady_clock, typename Sink = Logpp>
+class SlidingLogLogger : public FormatLogging<SlidingLogLogger<Clock, Sink>> {
 public:
-    void Info(const std::string_view message) {
-        log(Logpp::Level::info, message);
+    using FormatLogging<SlidingLogLogger>::Info;
+    using FormatLogging<SlidingLogLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
+    }
+
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
     }
 
-    void Error(const std::string_view message) {
-        log(Logpp::Level::error, message);
+    explicit SlidingLogLogger(const long log_per_second = 100) :
+        m_limits(Rate {log_per_second}), m_seen(m_limits.Load()) {
     }
 
-    explicit SlidingLogLogger(const long log_per_second = 100) : m_rate(log_per_second) {
+    void SetRate(const long log_per_second) {
+        m_limits.Store(Rate {log_per_second});
     }
 
 private:
-    void evict(const std::chrono::steady_clock::time_point &tp) {
+    friend FormatLogging<SlidingLogLogger>;
+
+    // Keeps the share of the limit that is used when it drops, with the oldest entries going
+    // first. When it rises, the logged entries stay as they are, and the rest is free.
+    void reload() {
+        const auto old_limit = m_seen.limits.CountPerSecond();
+        if (not m_limits.Refresh(m_seen)) {
+            return;
+        }
+
+        const auto size = m_queue.size() * m_seen.limits.CountPerSecond() / old_limit;
+        while (m_queue.size() > size) {
+            m_queue.pop_front();
+        }
+    }
+
+    void evict(const typename Clock::time_point &tp) {
         const auto window_size = 1s;
         while (not m_queue.empty() and (tp - m_queue.front()) > window_size) {
-            m_queue.pop();
+            m_queue.pop_front();
         }
     }
 
-    void insert(std::chrono::steady_clock::time_point tp) {
-        m_queue.push(std::move(tp));
+    void insert(typename Clock::time_point tp) {
+        m_queue.push_back(std::move(tp));
     }
 
     auto isWithinLimit() const {
-        const auto limit = m_rate.CountPerSecond();
+        const auto limit = m_seen.limits.CountPerSecond();
         const decltype(limit) size = m_queue.size();
         return size < limit;
     }
 
-    void log(const Logpp::Level a_level, const std::string_view message) {
-        auto now = std::chrono::steady_clock::now();
+    template<typename Message>
+    bool log(const Logpp::Level a_level, const Message &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        auto now = Clock::now();
 
+        reload();
         evict(now);
 
-        if (isWithinLimit() and m_logger.Log(a_level, message)) {
+        if (isWithinLimit() and m_logger.Log(a_level, MessageOf(message))) {
             insert(std::move(now));
+            return true;
         }
+        return false;
     }
 
-    std::queue<std::chrono::steady_clock::time_point> m_queue;
-    Rate m_rate;
-    Logpp m_logger;
+    std::deque<typename Clock::time_point> m_queue;
+    ReloadableLimits m_limits;
+    ReloadableLimits::Version m_seen;
+    Sink m_logger;
 };
@@ -2,27 +2,52 @@
 
 #pragma once
 
+#include <cassert>
 #include <chrono>
+#include <utility>
 
+#include "format-logging.hpp"
 #include "logpp.hpp"
 #include "rate.hpp"
+#include "reloadable.hpp"
 
-class SlidingWindowCounterLogger {
+template<typename Clock = std::chrono::steady_clock, typename Sink = Logpp>
+class SlidingWindowCounterLogger :
+    public FormatLogging<SlidingWindowCounterLogger<Clock, Sink>> {
 public:
-    void Info(const std::string_view message) {
-        log(Logpp::Level::info, message);
+    using FormatLogging<SlidingWindowCounterLogger>::Info;
+    using FormatLogging<SlidingWindowCounterLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
     }
 
-    void Error(const std::string_view message) {
-        log(Logpp::Level::error, message);
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
     }
 
     explicit SlidingWindowCounterLogger(const long log_per_second = 100) :
-        m_rate(log_per_second) {
+        m_limits(Rate {log_per_second}), m_seen(m_limits.Load()) {
+    }
+
+    void SetRate(const long log_per_second) {
+        m_limits.Store(Rate {log_per_second});
     }
 
 private:
-    void evict(const std::chrono::steady_clock::time_point &floor_now) {
+    friend FormatLogging<SlidingWindowCounterLogger>;
+
+    // Scales both counters, so the share of the limit that is used stays the same.
+    void reload() {
+        const auto old_limit = m_seen.limits.CountPerSecond();
+        if (m_limits.Refresh(m_seen)) {
+            const auto new_limit = m_seen.limits.CountPerSecond();
+            m_last_count = m_last_count * new_limit / old_limit;
+            m_current_count = m_current_count * new_limit / old_limit;
+        }
+    }
+
+    void evict(const typename Clock::time_point &floor_now) {
         const auto window_size = 1s;
         const auto diff = floor_now - m_current_window;
         if (diff > 0s) {
@@ -38,29 +63,38 @@ private:
 
     bool isWithinLimit(const double current_percentage) const {
         const long count = m_last_count * (1 - current_percentage) + m_current_count;
-        return count < m_rate.CountPerSecond();
+        return count < m_seen.limits.CountPerSecond();
     }
 
     void insert() {
         ++m_current_count;
     }
 
-    void log(const Logpp::Level a_level, const std::string_view message) {
-        const auto now = std::chrono::steady_clock::now();
+    template<typename Message>
+    bool log(const Logpp::Level a_level, const Message &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        const auto now = Clock::now();
         const auto floor_now = std::chrono::floor<std::chrono::seconds>(now);
 
+        reload();
         evict(floor_now);
 
         const std::chrono::duration<double> diff = now - floor_now;
         const auto window_size = 1s;
-        if (isWithinLimit(diff / window_size) and m_logger.Log(a_level, message)) {
+        if (isWithinLimit(diff / window_size) and m_logger.Log(a_level, MessageOf(message))) {
             insert();
+            return true;
         }
+        return false;
     }
 
-    Rate m_rate;
-    Logpp m_logger;
-    std::chrono::steady_clock::time_point m_current_window;
+    ReloadableLimits m_limits;
+    ReloadableLimits::Version m_seen;
+    Sink m_logger;
+    typename Clock::time_point m_current_window;
     long m_last_count = 0;
     long m_current_count = 0;
 };
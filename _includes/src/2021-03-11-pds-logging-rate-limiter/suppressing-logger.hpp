@@ -0,0 +1,230 @@
+// suppressing-logger.hpp
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+
+#include "clocks.hpp"
+#include "format-logging.hpp"
+#include "logpp.hpp"
+
+struct SuppressionSettings {
+    std::chrono::nanoseconds period = std::chrono::seconds {1};
+    std::chrono::nanoseconds report_period = std::chrono::seconds {1};
+    std::uint64_t sample_every = 1;
+    std::size_t sites = 1024;
+};
+
+// A fixed number of call sites, claimed with a CAS and never released, so lookups are lock
+// free and the memory is bounded. A key that finds no slot within a few probes gets nullptr.
+// The thread that claims a site labels it with the level and the first MAX_TEXT_SIZE characters
+// of its text, for the summaries written by Flush().
+class SuppressionTable {
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::size_t MAX_PROBES = 8;
+    static constexpr std::uint64_t EMPTY = 0;
+
+public:
+    static constexpr std::size_t MAX_TEXT_SIZE = 80;
+
+    struct alignas(CACHE_LINE_SIZE) Site {
+        std::atomic<std::uint64_t> key {EMPTY};
+        std::atomic<std::uint64_t> calls {0};
+        std::atomic<std::int64_t> window_end {0};
+        std::atomic<std::uint64_t> repeats {0};
+        std::atomic<bool> labeled {false};
+        Logpp::Level level = Logpp::Level::info;
+        std::size_t text_size = 0;
+        char text[MAX_TEXT_SIZE] {};
+    };
+
+    explicit SuppressionTable(const std::size_t size) :
+        m_mask(std::bit_ceil(std::max<std::size_t>(size, 1)) - 1),
+        m_sites(std::make_unique<Site[]>(m_mask + 1)) {
+    }
+
+    Site *Find(std::uint64_t key, const Logpp::Level a_level, const std::string_view text) {
+        key = key == EMPTY ? EMPTY + 1 : key;
+        auto index = mix(key);
+        for (std::size_t probe = 0; probe < MAX_PROBES; ++probe, ++index) {
+            auto &a_site = m_sites[index & m_mask];
+            auto found = a_site.key.load(std::memory_order_acquire);
+            if (found == EMPTY and a_site.key.compare_exchange_strong(found, key)) {
+                a_site.level = a_level;
+                a_site.text_size = std::min(text.size(), MAX_TEXT_SIZE);
+                std::memcpy(a_site.text, text.data(), a_site.text_size);
+                a_site.labeled.store(true, std::memory_order_release);
+                return &a_site;
+            }
+            if (found == key) {
+                return &a_site;
+            }
+        }
+        return nullptr;
+    }
+
+    // Visits every site whose label is written.
+    template<typename Visit>
+    void ForEach(const Visit &visit) {
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            if (m_sites[i].labeled.load(std::memory_order_acquire)) {
+                visit(m_sites[i]);
+            }
+        }
+    }
+
+private:
+    static std::uint64_t mix(std::uint64_t key) {
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111eb;
+        return key ^ (key >> 31);
+    }
+
+    const std::size_t m_mask;
+    std::unique_ptr<Site[]> m_sites;
+};
+
+// Sits in front of a rate-limited logger. A site is a format string: 1 in sample_every of its
+// calls goes on, and its repeats within a period are collapsed into one summary. Plain messages
+// go on as they are. What the limiter drops is counted and reported once per report_period.
+// Summaries and reports go straight to the sink, as there is at most one per site and period.
+// Calls into the wrapped logger are serialized, as most limiter loggers are not thread safe.
+template<typename Logger, typename Clock = std::chrono::steady_clock, typename Sink = Logpp>
+class SuppressingLogger : public FormatLogging<SuppressingLogger<Logger, Clock, Sink>> {
+public:
+    using FormatLogging<SuppressingLogger>::Info;
+    using FormatLogging<SuppressingLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
+    }
+
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
+    }
+
+    template<typename... Args>
+    explicit SuppressingLogger(const SuppressionSettings &settings, Args &&...args) :
+        m_period(settings.period.count()), m_report_period(settings.report_period.count()),
+        m_sample_every(std::max<std::uint64_t>(settings.sample_every, 1)),
+        m_sites(settings.sites), m_logger(std::forward<Args>(args)...) {
+    }
+
+    Logger &Inner() {
+        return m_logger;
+    }
+
+    // Writes the summaries of the repeats not yet summarized, and reports what was dropped or
+    // sampled out since the last report, if anything.
+    void Flush() {
+        m_sites.ForEach([this](SuppressionTable::Site &a_site) {
+            if (const auto repeats = a_site.repeats.exchange(0, std::memory_order_relaxed)) {
+                const std::string_view text {a_site.text, a_site.text_size};
+                m_sink.Log(a_site.level, FormatLog("suppressed {} repeats of: {}", repeats, text));
+            }
+        });
+        reportDropped();
+    }
+
+private:
+    friend FormatLogging<SuppressingLogger>;
+
+    void reportDropped() {
+        const auto dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+        const auto sampled_out = m_sampled_out.exchange(0, std::memory_order_relaxed);
+        if (dropped or sampled_out) {
+            m_sink.Log(Logpp::Level::warning,
+                       FormatLog("{} messages dropped by the limiter, {} sampled out", dropped,
+                                 sampled_out));
+        }
+    }
+
+    // Plain messages may be built at run time, and each distinct one would claim a site for good,
+    // so they get none.
+    bool log(const Logpp::Level a_level, const std::string_view message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        report(NanosecondsOf<Clock>(Clock::now()));
+        return pass(a_level, message);
+    }
+
+    // A format string is keyed by its address, as there is one per call site.
+    template<typename... Args>
+    bool log(const Logpp::Level a_level, const LogMessage<Args...> &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        const auto now = NanosecondsOf<Clock>(Clock::now());
+        report(now);
+
+        const auto site = message.Format();
+        const auto key = std::hash<const void *> {}(site.data());
+        if (auto *a_site = m_sites.Find(key, a_level, site)) {
+            if (m_sample_every > 1 and
+                a_site->calls.fetch_add(1, std::memory_order_relaxed) % m_sample_every != 0) {
+                m_sampled_out.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto window_end = a_site->window_end.load(std::memory_order_relaxed);
+            if (now < window_end or not a_site->window_end.compare_exchange_strong(
+                                        window_end, now + m_period, std::memory_order_relaxed)) {
+                a_site->repeats.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (const auto repeats = a_site->repeats.exchange(0, std::memory_order_relaxed)) {
+                m_sink.Log(a_level, FormatLog("suppressed {} repeats of: {}", repeats, site));
+            }
+        }
+        return message.Apply([&](const auto &...parts) {
+            return pass(a_level, parts...);
+        });
+    }
+
+    // Hands the message, still unformatted, to the wrapped logger at its level.
+    template<typename... Message>
+    bool pass(const Logpp::Level a_level, const Message &...message) {
+        std::unique_lock<std::mutex> lock {m_logger_mutex};
+        const auto logged =
+            a_level == Logpp::Level::error ? m_logger.Error(message...) : m_logger.Info(message...);
+        if (logged) {
+            return true;
+        }
+        lock.unlock();
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void report(const std::int64_t now) {
+        auto next = m_next_report.load(std::memory_order_relaxed);
+        if (now >= next and m_next_report.compare_exchange_strong(next, now + m_report_period,
+                                                                  std::memory_order_relaxed)) {
+            reportDropped();
+        }
+    }
+
+    const std::int64_t m_period;
+    const std::int64_t m_report_period;
+    const std::uint64_t m_sample_every;
+    SuppressionTable m_sites;
+    std::atomic<std::int64_t> m_next_report {0};
+    std::atomic<std::uint64_t> m_dropped {0};
+    std::atomic<std::uint64_t> m_sampled_out {0};
+    std::mutex m_logger_mutex;
+    Logger m_logger;
+    Sink m_sink;
+};
@@ -0,0 +1,151 @@
+// suppressing-logger.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "clocks.hpp"
+#include "suppressing-logger.hpp"
+#include "token-bucket-logger.hpp"
+
+
+class RecordingSink {
+public:
+    bool Log(const Logpp::Level, const std::string_view message) const {
+        std::lock_guard<std::mutex> guard {mutex};
+        messages.emplace_back(message);
+        return true;
+    }
+
+    static inline std::mutex mutex;
+    static inline std::vector<std::string> messages;
+};
+
+using Logger = SuppressingLogger<TokenBucketLogger<ManualClock, RecordingSink>,
+                                 ManualClock,
+                                 RecordingSink>;
+
+class SuppressingLoggerTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ManualClock::Reset(1s);
+        RecordingSink::messages.clear();
+    }
+};
+
+TEST_F(SuppressingLoggerTests, TestCollapsesRepeats) {
+    Logger logger {SuppressionSettings {}, 100};
+
+    for (auto i = 0; i < 10; ++i) {
+        logger.Info("same {}", i);
+    }
+    logger.Info("other {}", 1);
+    logger.Info("other {}", 2);
+    EXPECT_EQ((std::vector<std::string> {"same 0", "other 1"}), RecordingSink::messages);
+
+    ManualClock::Advance(1s);
+    logger.Info("same {}", 10);
+    logger.Info("other {}", 3);
+    EXPECT_EQ((std::vector<std::string> {"same 0",
+                                         "other 1",
+                                         "suppressed 9 repeats of: same {}",
+                                         "same 10",
+                                         "suppressed 1 repeats of: other {}",
+                                         "other 3"}),
+              RecordingSink::messages);
+}
+
+TEST_F(SuppressingLoggerTests, TestFlushSummarizesPendingRepeats) {
+    Logger logger {SuppressionSettings {}, 100};
+
+    for (auto i = 0; i < 5; ++i) {
+        logger.Info("quiet {}", i);
+    }
+    logger.Flush();
+    EXPECT_EQ((std::vector<std::string> {"quiet 0", "suppressed 4 repeats of: quiet {}"}),
+              RecordingSink::messages);
+
+    ManualClock::Advance(1s);
+    logger.Info("quiet {}", 5);
+    EXPECT_EQ((std::vector<std::string> {"quiet 0",
+                                         "suppressed 4 repeats of: quiet {}",
+                                         "quiet 5"}),
+              RecordingSink::messages);
+}
+
+TEST_F(SuppressingLoggerTests, TestSamplesPerSite) {
+    Logger logger {SuppressionSettings {.period = 0s, .sample_every = 4}, 100};
+
+    for (auto i = 0; i < 8; ++i) {
+        logger.Info("sampled {}", i);
+    }
+    logger.Error("kept");
+    EXPECT_EQ((std::vector<std::string> {"sampled 0", "sampled 4", "kept"}),
+              RecordingSink::messages);
+
+    RecordingSink::messages.clear();
+    logger.Flush();
+    EXPECT_EQ(std::vector<std::string> {"0 messages dropped by the limiter, 6 sampled out"},
+              RecordingSink::messages);
+}
+
+TEST_F(SuppressingLoggerTests, TestReportsDroppedMessagesOncePerPeriod) {
+    Logger logger {SuppressionSettings {.period = 0s}, 1};
+
+    for (auto i = 0; i < 5; ++i) {
+        logger.Info("message {}", i);
+    }
+    EXPECT_EQ(std::vector<std::string> {"message 0"}, RecordingSink::messages);
+
+    ManualClock::Advance(1s);
+    logger.Error("late");
+    EXPECT_EQ((std::vector<std::string> {"message 0",
+                                         "4 messages dropped by the limiter, 0 sampled out",
+                                         "late"}),
+              RecordingSink::messages);
+}
+
+TEST_F(SuppressingLoggerTests, TestFullTableStopsSuppressing) {
+    Logger logger {SuppressionSettings {.sites = 1}, 100};
+
+    for (auto i = 0; i < 2; ++i) {
+        logger.Info("first {}", i);
+        logger.Info("second {}", i);
+    }
+    EXPECT_EQ((std::vector<std::string> {"first 0", "second 0", "second 1"}),
+              RecordingSink::messages);
+}
+
+TEST_F(SuppressingLoggerTests, TestPlainMessagesTakeNoSite) {
+    Logger logger {SuppressionSettings {.sites = 1}, 100};
+
+    for (auto i = 0; i < 3; ++i) {
+        logger.Info("plain " + std::to_string(i));
+    }
+    logger.Info("plain 0");
+    logger.Info("site {}", 0);
+    logger.Info("site {}", 1);
+    EXPECT_EQ((std::vector<std::string> {"plain 0", "plain 1", "plain 2", "plain 0", "site 0"}),
+              RecordingSink::messages);
+}
+
+TEST_F(SuppressingLoggerTests, TestCollapsesRepeatsAcrossThreads) {
+    constexpr auto THREADS = 8;
+    constexpr auto CALLS = 10000;
+    Logger logger {SuppressionSettings {.period = 1h}, 100};
+
+    std::vector<std::jthread> threads;
+    for (auto i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&logger] {
+            for (auto i = 0; i < CALLS; ++i) {
+                logger.Info("hammered {}", i);
+            }
+        });
+    }
+    threads.clear();
+
+    EXPECT_EQ(std::vector<std::string> {"hammered 0"}, RecordingSink::messages);
+}
@@ -0,0 +1,7 @@
+#include "suppressing-logger.hpp"
+#include "test-utils.hpp"
+#include "token-bucket-logger.hpp"
+
+int main() {
+    TestLimiterLogger(SuppressingLogger<TokenBucketLogger<>> {SuppressionSettings {}, 3});
+}
@@ -0,0 +1,409 @@
+// timer-wheel.hpp
+
+#pragma once
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/*
+ * A hierarchical timing wheel: LEVEL_COUNT levels of SLOT_COUNT slots, each level covering
+ * SLOT_COUNT times the span of the one below. Timers live on intrusive lists, so both
+ * Schedule() and Cancel() are O(1), and are cascaded down a level when their slot comes
+ * up. A whole level-0 slot expires as one batch whose callbacks run outside the lock.
+ *
+ * The wheel is driven either by its own thread, which sleeps until the next occupied slot,
+ * or by a timerfd which the owner polls and then calls Dispatch(). Timers never fire
+ * early, and late by at most one tick plus the wakeup latency.
+ */
+class TimerWheel {
+    struct Timer;
+
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    enum class Driver {
+        thread,
+        timerfd,
+    };
+
+    class Handle {
+        friend class TimerWheel;
+        Handle(Timer *timer, const std::uint64_t generation) :
+            m_timer(timer), m_generation(generation) {
+        }
+
+    public:
+        Handle() = default;
+
+    private:
+        Timer *m_timer = nullptr;
+        std::uint64_t m_generation = 0;
+    };
+
+    explicit TimerWheel(const Driver driver = Driver::thread,
+                        const Clock::duration tick = 100us) :
+        m_driver(driver), m_tick(tick) {
+        if (m_driver == Driver::timerfd) {
+            m_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            if (m_fd == -1) {
+                throw std::system_error(errno, std::system_category(), "timerfd_create");
+            }
+        } else {
+            m_thread = std::thread(&TimerWheel::run, this);
+        }
+    }
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    ~TimerWheel() {
+        if (m_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard {m_mutex};
+                m_stopping = true;
+            }
+            m_cv.notify_one();
+            m_thread.join();
+        }
+        if (m_fd != -1) {
+            close(m_fd);
+        }
+    }
+
+    Handle Schedule(const Clock::time_point deadline, Callback callback) {
+        std::unique_lock<std::mutex> lock {m_mutex};
+        if (not m_size) {
+            m_now = std::max(m_now, ticksOf(Clock::now()));
+        }
+
+        auto &a_timer = allocate();
+        a_timer.expiry = std::max(expiryOf(deadline), m_now + 1);
+        a_timer.callback = std::move(callback);
+        insert(a_timer);
+
+        const Handle handle {&a_timer, a_timer.generation};
+        if (timeOf(a_timer.expiry) < m_next_wakeup) {
+            wakeUp(lock);
+        }
+        return handle;
+    }
+
+    // Returns whether the timer was still pending. Unless called from a callback, it also
+    // waits for the batch being dispatched, so the callback is not running once it returns.
+    bool Cancel(const Handle handle) {
+        std::unique_lock<std::mutex> lock {m_mutex};
+        auto *a_timer = handle.m_timer;
+        const auto pending = a_timer and a_timer->generation == handle.m_generation;
+        if (pending) {
+            unlink(*a_timer);
+            release(*a_timer);
+        }
+
+        m_dispatched_cv.wait(lock, [this] {
+            return not m_dispatching or m_dispatcher == std::this_thread::get_id();
+        });
+        return pending;
+    }
+
+    int Fd() const {
+        return m_fd;
+    }
+
+    void Dispatch() {
+        std::uint64_t expirations = 0;
+        [[maybe_unused]] const auto bytes = read(m_fd, &expirations, sizeof(expirations));
+
+        std::unique_lock<std::mutex> lock {m_mutex};
+        dispatch(lock);
+        m_next_wakeup = Clock::time_point::max();
+        if (const auto next = nextExpiry()) {
+            arm(*next);
+        }
+    }
+
+    std::size_t Size() const {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        return m_size;
+    }
+
+    static auto &Shared() {
+        static TimerWheel wheel;
+        return wheel;
+    }
+
+private:
+    static constexpr unsigned LEVEL_BITS = 6;
+    static constexpr std::size_t SLOT_COUNT = 1 << LEVEL_BITS;
+    static constexpr std::size_t LEVEL_COUNT = 6;
+    static constexpr std::int64_t MAX_DELTA =
+        (std::int64_t {1} << (LEVEL_BITS * LEVEL_COUNT)) - 1;
+
+    struct Timer {
+        Timer *prev = nullptr;
+        Timer *next = nullptr;
+        std::int64_t expiry = 0;
+        std::uint64_t generation = 0;
+        unsigned level = 0;
+        unsigned slot = 0;
+        Callback callback;
+    };
+
+    struct Level {
+        std::array<Timer *, SLOT_COUNT> heads {};
+        std::array<Timer *, SLOT_COUNT> tails {};
+        std::uint64_t occupied = 0;
+    };
+
+    std::int64_t ticksOf(const Clock::time_point time_point) const {
+        return (time_point - m_origin) / m_tick;
+    }
+
+    std::int64_t expiryOf(const Clock::time_point deadline) const {
+        return (deadline - m_origin + m_tick - Clock::duration {1}) / m_tick;
+    }
+
+    Clock::time_point timeOf(const std::int64_t tick) const {
+        return m_origin + tick * m_tick;
+    }
+
+    static unsigned slotOf(const std::int64_t tick, const unsigned level) {
+        return (tick >> (LEVEL_BITS * level)) & (SLOT_COUNT - 1);
+    }
+
+    Timer &allocate() {
+        if (m_free) {
+            return *std::exchange(m_free, m_free->next);
+        }
+        return m_pool.emplace_back();
+    }
+
+    void release(Timer &a_timer) {
+        ++a_timer.generation;
+        a_timer.callback = nullptr;
+        a_timer.next = std::exchange(m_free, &a_timer);
+    }
+
+    void insert(Timer &a_timer) {
+        const auto target = m_now + std::min(a_timer.expiry - m_now, MAX_DELTA);
+
+        unsigned level = 0;
+        while (level + 1 < LEVEL_COUNT and
+               (target - m_now) >> (LEVEL_BITS * (level + 1)) != 0) {
+            ++level;
+        }
+        link(a_timer, level, slotOf(target, level));
+    }
+
+    void link(Timer &a_timer, const unsigned level, const unsigned slot) {
+        auto &a_level = m_levels[level];
+        a_timer.level = level;
+        a_timer.slot = slot;
+        a_timer.next = nullptr;
+        a_timer.prev = std::exchange(a_level.tails[slot], &a_timer);
+        if (a_timer.prev) {
+            a_timer.prev->next = &a_timer;
+        } else {
+            a_level.heads[slot] = &a_timer;
+        }
+        a_level.occupied |= std::uint64_t {1} << slot;
+        ++m_size;
+    }
+
+    void unlink(Timer &a_timer) {
+        auto &a_level = m_levels[a_timer.level];
+        if (a_timer.prev) {
+            a_timer.prev->next = a_timer.next;
+        } else {
+            a_level.heads[a_timer.slot] = a_timer.next;
+        }
+        if (a_timer.next) {
+            a_timer.next->prev = a_timer.prev;
+        } else {
+            a_level.tails[a_timer.slot] = a_timer.prev;
+        }
+        if (not a_level.heads[a_timer.slot]) {
+            a_level.occupied &= ~(std::uint64_t {1} << a_timer.slot);
+        }
+        --m_size;
+    }
+
+    Timer *takeSlot(const unsigned level, const unsigned slot) {
+        auto &a_level = m_levels[level];
+        a_level.occupied &= ~(std::uint64_t {1} << slot);
+        a_level.tails[slot] = nullptr;
+        auto *timers = std::exchange(a_level.heads[slot], nullptr);
+        for (auto *a_timer = timers; a_timer; a_timer = a_timer->next) {
+            --m_size;
+        }
+        return timers;
+    }
+
+    // The tick at which the next occupied slot expires, or is cascaded down a level.
+    std::optional<std::int64_t> nextEventTick() const {
+        std::optional<std::int64_t> earliest;
+        for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+            const auto occupied = m_levels[level].occupied;
+            if (not occupied) {
+                continue;
+            }
+
+            const auto index = slotOf(m_now, level);
+            const auto later =
+                index + 1 < SLOT_COUNT ? occupied & (~std::uint64_t {0} << (index + 1)) : 0;
+            const std::int64_t slot =
+                later ? std::countr_zero(later) : std::countr_zero(occupied) + SLOT_COUNT;
+            const auto tick = ((m_now >> (LEVEL_BITS * level)) - index + slot)
+                              << (LEVEL_BITS * level);
+            earliest = std::min(earliest.value_or(tick), tick);
+        }
+        return earliest;
+    }
+
+    std::optional<Clock::time_point> nextExpiry() const {
+        if (const auto tick = nextEventTick()) {
+            return timeOf(*tick);
+        }
+        return std::nullopt;
+    }
+
+    void advance(const std::int64_t target) {
+        while (m_now < target) {
+            const auto next = nextEventTick();
+            if (not next or *next > target) {
+                m_now = target;
+                return;
+            }
+
+            m_now = *next;
+            for (auto level = LEVEL_COUNT - 1; level > 0; --level) {
+                if (m_now & ((std::int64_t {1} << (LEVEL_BITS * level)) - 1)) {
+                    continue;
+                }
+                for (auto *a_timer = takeSlot(level, slotOf(m_now, level)); a_timer;) {
+                    auto *next_timer = a_timer->next;
+                    insert(*a_timer);
+                    a_timer = next_timer;
+                }
+            }
+
+            for (auto *a_timer = takeSlot(0, slotOf(m_now, 0)); a_timer;) {
+                auto *next_timer = a_timer->next;
+                if (a_timer->expiry > m_now) {
+                    insert(*a_timer);
+                } else {
+                    m_expired.push_back(std::move(a_timer->callback));
+                    release(*a_timer);
+                }
+                a_timer = next_timer;
+            }
+        }
+    }
+
+    void dispatch(std::unique_lock<std::mutex> &lock) {
+        advance(ticksOf(Clock::now()));
+        if (m_expired.empty()) {
+            return;
+        }
+
+        std::vector<Callback> batch;
+        batch.swap(m_expired);
+        m_dispatching = true;
+        m_dispatcher = std::this_thread::get_id();
+        lock.unlock();
+
+        for (auto &a_callback : batch) {
+            a_callback();
+        }
+
+        batch.clear();
+        lock.lock();
+        m_dispatching = false;
+        if (m_expired.empty()) {
+            m_expired.swap(batch);
+        }
+        m_dispatched_cv.notify_all();
+    }
+
+    void arm(const Clock::time_point time_point) {
+        m_next_wakeup = time_point;
+
+        const auto since_epoch = std::max(time_point.time_since_epoch(), Clock::duration {1});
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        itimerspec spec {};
+        spec.it_value.tv_sec = seconds.count();
+        spec.it_value.tv_nsec =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count();
+        timerfd_settime(m_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    void wakeUp(std::unique_lock<std::mutex> &lock) {
+        if (m_driver == Driver::timerfd) {
+            arm(*nextExpiry());
+        } else {
+            m_next_wakeup = Clock::time_point::min();
+            lock.unlock();
+            m_cv.notify_one();
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock {m_mutex};
+        while (not m_stopping) {
+            dispatch(lock);
+            // The destructor may have asked to stop while dispatch() ran the callbacks unlocked.
+            if (m_stopping) {
+                break;
+            }
+
+            if (const auto next = nextExpiry()) {
+                m_next_wakeup = *next;
+                m_cv.wait_until(lock, m_next_wakeup);
+            } else {
+                m_next_wakeup = Clock::time_point::max();
+                m_cv.wait(lock);
+            }
+        }
+    }
+
+    const Driver m_driver;
+    const Clock::time_point m_origin = Clock::now();
+    const Clock::duration m_tick;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_dispatched_cv;
+
+    std::array<Level, LEVEL_COUNT> m_levels {};
+    std::deque<Timer> m_pool;
+    Timer *m_free = nullptr;
+    std::int64_t m_now = 0;
+    std::size_t m_size = 0;
+    std::vector<Callback> m_expired;
+
+    Clock::time_point m_next_wakeup = Clock::time_point::max();
+    bool m_dispatching = false;
+    std::thread::id m_dispatcher;
+    bool m_stopping = false;
+
+    int m_fd = -1;
+    std::thread m_thread;
+};
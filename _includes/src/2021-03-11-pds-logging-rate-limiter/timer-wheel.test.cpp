@@ -0,0 +1,104 @@
+// timer-wheel.test.cpp
+
+#include <gtest/gtest.h>
+
+#include <poll.h>
+
+#include <atomic>
+#include <latch>
+#include <mutex>
+#include <vector>
+
+#include "timer-wheel.hpp"
+
+using Clock = TimerWheel::Clock;
+
+
+TEST(TimerWheelTests, TestTimersFireInDeadlineOrderAndNeverEarly) {
+    constexpr std::size_t TIMER_COUNT = 200;
+
+    TimerWheel wheel {TimerWheel::Driver::thread, 10us};
+    std::mutex mutex;
+    std::vector<std::size_t> order;
+    std::latch done {TIMER_COUNT};
+
+    const auto start = Clock::now();
+    for (std::size_t i = TIMER_COUNT; i-- > 0;) {
+        const auto deadline = start + i * 500us;
+        wheel.Schedule(deadline, [&, i, deadline] {
+            EXPECT_GE(Clock::now(), deadline);
+            std::lock_guard<std::mutex> guard {mutex};
+            order.push_back(i);
+            done.count_down();
+        });
+    }
+    done.wait();
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(TimerWheelTests, TestFarTimersAreCascaded) {
+    constexpr Clock::duration DELAYS[] {300000us, 5000us, 70us};
+
+    TimerWheel wheel {TimerWheel::Driver::thread, 1us};
+    std::mutex mutex;
+    std::vector<Clock::duration> order;
+    std::latch done {std::size(DELAYS)};
+
+    const auto start = Clock::now();
+    for (const auto delay : DELAYS) {
+        const auto deadline = start + delay;
+        wheel.Schedule(deadline, [&, delay, deadline] {
+            EXPECT_GE(Clock::now(), deadline);
+            std::lock_guard<std::mutex> guard {mutex};
+            order.push_back(delay);
+            done.count_down();
+        });
+    }
+    done.wait();
+
+    std::lock_guard<std::mutex> guard {mutex};
+    EXPECT_EQ((std::vector<Clock::duration> {70us, 5000us, 300000us}), order);
+}
+
+TEST(TimerWheelTests, TestCancel) {
+    TimerWheel wheel;
+    std::atomic<int> fired {0};
+
+    const auto handle = wheel.Schedule(Clock::now() + 20ms, [&fired] {
+        ++fired;
+    });
+    wheel.Schedule(Clock::now() + 10ms, [&fired] {
+        fired += 10;
+    });
+    EXPECT_EQ(2u, wheel.Size());
+    EXPECT_TRUE(wheel.Cancel(handle));
+    EXPECT_FALSE(wheel.Cancel(handle));
+    EXPECT_EQ(1u, wheel.Size());
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(10, fired.load());
+}
+
+TEST(TimerWheelTests, TestTimerfdDriver) {
+    TimerWheel wheel {TimerWheel::Driver::timerfd};
+    std::vector<int> fired;
+
+    const auto start = Clock::now();
+    wheel.Schedule(start + 5ms, [&fired] {
+        fired.push_back(1);
+    });
+    wheel.Schedule(start + 2ms, [&fired] {
+        fired.push_back(0);
+    });
+
+    pollfd fd {wheel.Fd(), POLLIN, 0};
+    while (fired.size() < 2 and poll(&fd, 1, 1000) == 1) {
+        wheel.Dispatch();
+    }
+
+    EXPECT_EQ((std::vector<int> {0, 1}), fired);
+    EXPECT_GE(Clock::now() - start, 5ms);
+}
@@ -2,33 +2,60 @@
 
 #pragma once
 
+#include "format-logging.hpp"
 #include "logpp.hpp"
+#include "reloadable.hpp"
 #include "token-bucket.hpp"
 
-class TokenBucketLogger {
+template<typename Clock = std::chrono::steady_clock,
+         typename Sink = Logpp,
+         typename Limiter = TokenBucketLimiter<Clock>>
+class TokenBucketLogger : public FormatLogging<TokenBucketLogger<Clock, Sink, Limiter>> {
 public:
-    void Info(const std::string_view message) {
-        log(Logpp::Level::info, message);
+    using FormatLogging<TokenBucketLogger>::Info;
+    using FormatLogging<TokenBucketLogger>::Error;
+
+    bool Info(const std::string_view message) {
+        return log(Logpp::Level::info, message);
     }
 
-    void Error(const std::string_view message) {
-        log(Logpp::Level::error, message);
+    bool Error(const std::string_view message) {
+        return log(Logpp::Level::error, message);
     }
 
     explicit TokenBucketLogger(const long log_per_second = 100) :
-        m_limiter(Rate {log_per_second}) {
+        m_limits(Rate {log_per_second}), m_seen(m_limits.Load()), m_limiter(m_seen.limits) {
+    }
+
+    void SetRate(const long log_per_second) {
+        m_limits.Store(Rate {log_per_second});
     }
 
 private:
-    void log(const Logpp::Level a_level, const std::string_view message) {
+    friend FormatLogging<TokenBucketLogger>;
+
+    template<typename Message>
+    bool log(const Logpp::Level a_level, const Message &message) {
+        if (not Logpp::IsEnabled(a_level)) {
+            return true;
+        }
+
+        if (m_limits.Refresh(m_seen)) {
+            m_limiter.SetLimits(m_seen.limits);
+        }
+
         auto a_token = m_limiter.FetchToken();
         if (a_token) {
-            if (not m_logger.Log(a_level, message)) {
-                a_token.Return();
+            if (m_logger.Log(a_level, MessageOf(message))) {
+                return true;
             }
+            a_token.Return();
         }
+        return false;
     }
 
-    TokenBucketLimiter m_limiter;
-    Logpp m_logger;
+    ReloadableLimits m_limits;
+    ReloadableLimits::Version m_seen;
+    Limiter m_limiter;
+    Sink m_logger;
 };
@@ -1,6 +1,9 @@
+#include "instrumented-limiter.hpp"
+#include "instrumented-sink.hpp"
 #include "test-utils.hpp"
 #include "token-bucket-logger.hpp"
 
 int main() {
-    TestLimiterLogger(TokenBucketLogger {3});
+    TestLimiterLogger(
+        TokenBucketLogger<std::chrono::steady_clock, InstrumentedSink<>, InstrumentedLimiter<>> {3});
 }
@@ -2,51 +2,83 @@
 
 #pragma once
 
-#include <memory>
+#include <algorithm>
+#include <chrono>
 
 #include "rate.hpp"
 #include "token.hpp"
 
+template<typename Clock = std::chrono::steady_clock, typename RateType = Rate>
 class TokenBucketLimiter {
 public:
-    explicit TokenBucketLimiter(Rate rate) :
-        m_rate(std::move(rate)), m_token_count(std::make_shared<long>(0)) {
-        *m_token_count = m_capacity = m_rate.CountPerSecond();
+    enum class FetchMode {
+        all_or_nothing,
+        partial,
+    };
+
+    TokenBucketLimiter() = default;
+
+    explicit TokenBucketLimiter(const Rate &rate) :
+        TokenBucketLimiter(RateLimits<RateType> {rate}) {
+    }
+
+    TokenBucketLimiter(const Rate &rate, const long capacity) :
+        TokenBucketLimiter(RateLimits<RateType> {rate, capacity}) {
     }
 
-    TokenBucketLimiter(Rate rate, const long capacity) :
-        m_rate(std::move(rate)), m_capacity(capacity),
-        m_token_count(std::make_shared<long>(capacity)) {
+    explicit TokenBucketLimiter(const RateLimits<RateType> &limits) : m_limits(limits) {
     }
 
+    // Its tokens and leases point at its count, so it stays where it is.
+    TokenBucketLimiter(const TokenBucketLimiter &) = delete;
+    TokenBucketLimiter &operator=(const TokenBucketLimiter &) = delete;
+
     auto FetchToken() {
         fill();
 
-        if (*m_token_count > 0) {
-            --(*m_token_count);
+        if (m_token_count > 0) {
+            --m_token_count;
             return Token {m_token_count};
         }
 
         return Token {};
     }
 
+    auto FetchTokens(const long n, const FetchMode mode = FetchMode::all_or_nothing) {
+        fill();
+
+        const auto granted = mode == FetchMode::partial ? std::min(n, m_token_count) :
+                             n <= m_token_count         ? n :
+                                                          0;
+        if (granted > 0) {
+            m_token_count -= granted;
+            return TokenLease {m_token_count, granted};
+        }
+
+        return TokenLease {};
+    }
+
+    // Keeps the share of the capacity that is left.
+    void SetLimits(const RateLimits<RateType> &limits) {
+        m_token_count = m_token_count * limits.Capacity() / m_limits.Capacity();
+        m_limits = limits;
+    }
+
 private:
     void fill() {
-        const auto now = std::chrono::steady_clock::now();
+        const auto now = Clock::now();
         const auto duration = now - m_last_time;
         const auto seconds_count =
             std::chrono::duration_cast<std::chrono::seconds>(duration).count();
         if (seconds_count) {
             m_last_time = now;
 
-            *m_token_count =
-                std::min(m_capacity, *m_token_count + m_rate.CountPerSecond() * seconds_count);
+            m_token_count = std::min(m_limits.Capacity(),
+                                     m_token_count + m_limits.CountPerSecond() * seconds_count);
         }
     }
 
-    std::chrono::time_point<std::chrono::steady_clock> m_last_time =
-        std::chrono::steady_clock::now();
-    Rate m_rate {0};
-    long m_capacity = 0;
-    std::shared_ptr<long> m_token_count;
+    typename Clock::time_point m_last_time = Clock::now();
+    [[no_unique_address]] RateLimits<RateType> m_limits;
+    long m_token_count = m_limits.Capacity();
 };
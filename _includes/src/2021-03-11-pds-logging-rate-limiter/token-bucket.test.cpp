@@ -0,0 +1,85 @@
+// token-bucket.test.cpp
+
+#include <gtest/gtest.h>
+
+#include "token-bucket.hpp"
+
+
+TEST(TokenBucketLimiterTests, TestReturnedTokenIsReused) {
+    TokenBucketLimiter limiter {Rate {1}};
+
+    {
+        auto a_token = limiter.FetchToken();
+        EXPECT_TRUE(a_token);
+        EXPECT_FALSE(limiter.FetchToken());
+        a_token.Return();
+    }
+    EXPECT_TRUE(limiter.FetchToken());
+}
+
+TEST(TokenBucketLimiterTests, TestAllOrNothingLease) {
+    TokenBucketLimiter limiter {Rate {1}, 10};
+
+    EXPECT_FALSE(limiter.FetchTokens(11));
+
+    const auto a_lease = limiter.FetchTokens(6);
+    EXPECT_EQ(6, a_lease.Count());
+    EXPECT_FALSE(limiter.FetchTokens(5));
+    EXPECT_EQ(4, limiter.FetchTokens(4).Count());
+}
+
+TEST(TokenBucketLimiterTests, TestPartialLease) {
+    TokenBucketLimiter limiter {Rate {1}, 10};
+    constexpr auto PARTIAL = TokenBucketLimiter<>::FetchMode::partial;
+
+    auto a_lease = limiter.FetchTokens(64, PARTIAL);
+    EXPECT_EQ(10, a_lease.Count());
+    EXPECT_FALSE(limiter.FetchTokens(1, PARTIAL));
+
+    a_lease.Return(3);
+    EXPECT_EQ(7, a_lease.Count());
+    EXPECT_EQ(3, limiter.FetchTokens(64, PARTIAL).Count());
+}
+
+TEST(TokenBucketLimiterTests, TestMovedLeaseReturnsOnce) {
+    TokenBucketLimiter limiter {Rate {1}, 10};
+
+    auto a_lease = limiter.FetchTokens(10);
+    auto another_lease = std::move(a_lease);
+    a_lease.Return();
+    another_lease.Return();
+
+    EXPECT_EQ(10, limiter.FetchTokens(64, TokenBucketLimiter<>::FetchMode::partial).Count());
+}
+
+TEST(TokenBucketLimiterTests, TestSetLimitsKeepsShareOfCapacity) {
+    TokenBucketLimiter limiter {Rate {1}, 10};
+
+    EXPECT_EQ(6, limiter.FetchTokens(6).Count());
+    limiter.SetLimits(RateLimits<> {Rate {1}, 20});
+    EXPECT_FALSE(limiter.FetchTokens(9));
+    EXPECT_EQ(8, limiter.FetchTokens(8).Count());
+}
+
+TEST(TokenBucketLimiterTests, TestMoveAssignmentCreditsReturnedToken) {
+    TokenBucketLimiter limiter {Rate {1}, 2};
+
+    auto a_token = limiter.FetchToken();
+    a_token.Return();
+    a_token = limiter.FetchToken();
+    EXPECT_TRUE(a_token);
+
+    EXPECT_TRUE(limiter.FetchToken());
+    EXPECT_FALSE(limiter.FetchToken());
+}
+
+TEST(TokenBucketLimiterTests, TestConstruction) {
+    static_assert(not std::is_copy_constructible_v<TokenBucketLimiter<>>);
+    static_assert(not std::is_move_constructible_v<TokenBucketLimiter<>>);
+
+    TokenBucketLimiter<std::chrono::steady_clock, StaticRate<10>> limiter = {};
+    EXPECT_EQ(10, limiter.FetchTokens(64, decltype(limiter)::FetchMode::partial).Count());
+
+    EXPECT_THROW(TokenBucketLimiter {Rate {0}}, std::invalid_argument);
+    EXPECT_THROW((TokenBucketLimiter {Rate {1}, 0}), std::invalid_argument);
+}
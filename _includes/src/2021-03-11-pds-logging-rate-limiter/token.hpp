@@ -2,26 +2,35 @@
 
 #pragma once
 
-#include <memory>
+#include <cassert>
+#include <utility>
 
+// A permit, which is consumed unless returned, and must not outlive its limiter.
 class Token {
+    template<typename, typename>
     friend class TokenBucketLimiter;
     Token() = default;
-    explicit Token(const std::shared_ptr<long> count) : m_count(count), m_valid(true) {
+    explicit Token(long &count) : m_count(&count), m_valid(true) {
     }
+
+public:
     Token(const Token &) = delete;
     Token &operator=(const Token &) = delete;
-    Token(Token &&) = default;
-    Token &operator=(Token &&) = default;
+    Token(Token &&other) noexcept :
+        m_count(std::exchange(other.m_count, nullptr)),
+        m_valid(std::exchange(other.m_valid, false)) {
+    }
+    Token &operator=(Token &&other) noexcept {
+        if (this != &other) {
+            release();
+            m_count = std::exchange(other.m_count, nullptr);
+            m_valid = std::exchange(other.m_valid, false);
+        }
+        return *this;
+    }
 
-public:
     ~Token() {
-        if (not m_valid) {
-            const auto count = m_count.lock();
-            if (count) {
-                ++(*count);
-            }
-        }
+        release();
     }
 
     void Return() {
@@ -33,6 +42,61 @@ public:
     }
 
 private:
-    std::weak_ptr<long> m_count;
+    void release() {
+        if (not m_valid and m_count) {
+            ++(*m_count);
+        }
+        m_count = nullptr;
+    }
+
+    long *m_count = nullptr;
     bool m_valid = false;
 };
+
+// A batch of permits, which are consumed unless returned, and must not outlive its limiter.
+class TokenLease {
+    template<typename, typename>
+    friend class TokenBucketLimiter;
+    TokenLease() = default;
+    TokenLease(long &count, const long granted) : m_count(&count), m_granted(granted) {
+    }
+
+public:
+    TokenLease(const TokenLease &) = delete;
+    TokenLease &operator=(const TokenLease &) = delete;
+    TokenLease(TokenLease &&other) noexcept :
+        m_count(std::exchange(other.m_count, nullptr)),
+        m_granted(std::exchange(other.m_granted, 0)) {
+    }
+    TokenLease &operator=(TokenLease &&other) noexcept {
+        if (this != &other) {
+            m_count = std::exchange(other.m_count, nullptr);
+            m_granted = std::exchange(other.m_granted, 0);
+        }
+        return *this;
+    }
+
+    auto Count() const {
+        return m_granted;
+    }
+
+    void Return(const long n) {
+        assert(n >= 0 and n <= m_granted);
+        if (m_count) {
+            *m_count += n;
+            m_granted -= n;
+        }
+    }
+
+    void Return() {
+        Return(m_granted);
+    }
+
+    explicit operator bool() const {
+        return m_granted > 0;
+    }
+
+private:
+    long *m_count = nullptr;
+    long m_granted = 0;
+};
@@ -0,0 +1,32 @@
+#include <cstdlib>
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "shutdown-registry.hpp"
+
+
+struct ExitException : public std::exception {
+    int error_code;
+
+    ExitException(const int c) : error_code(c) {
+    }
+};
+
+std::string buffered;
+
+void process() {
+    buffered += "still buffered when process() gives up\n";
+    throw ExitException {EXIT_SUCCESS};
+}
+
+int main() try {
+    ShutdownRegistry::Instance().Register(ShutdownRegistry::SINK_PRIORITY, [] {
+        std::cout << buffered << std::flush;
+    });
+
+    process();
+} catch (const ExitException &e) {
+    return e.error_code;
+}
@@ -0,0 +1,144 @@
+// alloc-tracker.cpp
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "alloc-tracker.hpp"
+
+namespace {
+
+// Calls the new handler until there is memory or there is no handler, as operator new would.
+template<typename Allocate>
+void *retry(const Allocate allocate) noexcept {
+    while (true) {
+        if (auto *memory = allocate()) {
+            return memory;
+        }
+
+        const auto handler = std::get_new_handler();
+        if (not handler) {
+            return nullptr;
+        }
+        try {
+            handler();
+        } catch (...) {
+            return nullptr;
+        }
+    }
+}
+
+void *allocate(const std::size_t size) noexcept {
+    return retry([size] {
+        return std::malloc(size ? size : 1);
+    });
+}
+
+void *allocate(const std::size_t size, const std::align_val_t alignment) noexcept {
+    const auto align = static_cast<std::size_t>(alignment);
+    const auto rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    return retry([align, rounded] {
+        return std::aligned_alloc(align, rounded);
+    });
+}
+
+void *orThrow(void *const memory) {
+    if (not memory) {
+        throw std::bad_alloc {};
+    }
+    return memory;
+}
+
+}
+
+void *operator new(const std::size_t size) {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return orThrow(allocate(size));
+}
+
+void *operator new[](const std::size_t size) {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return orThrow(allocate(size));
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return allocate(size);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return allocate(size);
+}
+
+void *operator new(const std::size_t size, const std::align_val_t alignment) {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return orThrow(allocate(size, alignment));
+}
+
+void *operator new[](const std::size_t size, const std::align_val_t alignment) {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return orThrow(allocate(size, alignment));
+}
+
+void *operator new(const std::size_t size,
+                   const std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return allocate(size, alignment);
+}
+
+void *operator new[](const std::size_t size,
+                     const std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+    AllocTracker::Instance().OnAllocation(size, __builtin_return_address(0));
+    return allocate(size, alignment);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
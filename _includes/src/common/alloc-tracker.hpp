@@ -0,0 +1,294 @@
+// alloc-tracker.hpp
+
+#pragma once
+
+#include <execinfo.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "symbolize.hpp"
+
+// Tracks the heap allocations of a program linked with the common.alloc-tracker object
+// library, which replaces the global operator new. Every allocation is counted per thread, and
+// once Start()ed, an allocation is sampled about every sample period bytes, so large ones are
+// more likely to be, and its call stack is aggregated into a fixed table without allocating.
+class AllocTracker {
+public:
+    static constexpr std::size_t MAX_DEPTH = 16;
+    static constexpr std::size_t SITE_COUNT = 1024;
+    static constexpr std::int64_t DEFAULT_SAMPLE_PERIOD = 64 * 1024;
+
+    // The estimated allocations of a call stack, innermost frame first.
+    struct Site {
+        std::vector<void *> frames;
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    // Constant initialized, so operator new can use it before main().
+    static AllocTracker &Instance() {
+        static AllocTracker tracker;
+        return tracker;
+    }
+
+    // Whether the operator new in use is the one that counts.
+    static bool Installed() {
+        static const bool installed = [] {
+            const auto before = ThreadAllocations();
+            ::operator delete(::operator new(1));
+            return ThreadAllocations() != before;
+        }();
+        return installed;
+    }
+
+    static std::uint64_t ThreadAllocations() {
+        return threadState().allocations;
+    }
+
+    // A sample period of 0 samples every allocation.
+    void Start(const std::int64_t sample_period = DEFAULT_SAMPLE_PERIOD) {
+        // The first backtrace() may load the unwinder.
+        void *frame = nullptr;
+        ::backtrace(&frame, 1);
+
+        m_sample_period.store(std::max<std::int64_t>(sample_period, 0), std::memory_order_relaxed);
+        m_running.store(true, std::memory_order_release);
+    }
+
+    void Stop() {
+        m_running.store(false, std::memory_order_release);
+    }
+
+    // Forgets the sites, while nothing is sampled.
+    void Reset() {
+        for (auto &a_slot : m_slots) {
+            a_slot.depth.store(0, std::memory_order_relaxed);
+            a_slot.count.store(0, std::memory_order_relaxed);
+            a_slot.bytes.store(0, std::memory_order_relaxed);
+            a_slot.key.store(0, std::memory_order_release);
+        }
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+
+    // The samples that did not fit in the table.
+    std::uint64_t Dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    // Called by the replaced operator new, with the return address of its caller.
+    void OnAllocation(const std::size_t size, void *const caller) noexcept {
+        auto &state = threadState();
+        ++state.allocations;
+        if (not m_running.load(std::memory_order_relaxed) or state.inside) {
+            return;
+        }
+
+        const auto bytes = static_cast<std::int64_t>(size);
+        if (bytes < state.until_sample) {
+            state.until_sample -= bytes;
+            return;
+        }
+
+        const auto period = m_sample_period.load(std::memory_order_relaxed);
+        state.until_sample = nextInterval(state, period);
+
+        state.inside = true;
+        void *frames[MAX_DEPTH + SKIPPED_FRAMES];
+        const auto depth = ::backtrace(frames, MAX_DEPTH + SKIPPED_FRAMES);
+        const auto first = std::find(frames, frames + depth, caller);
+        if (first != frames + depth) {
+            record(first,
+                   static_cast<int>(std::min<std::ptrdiff_t>(frames + depth - first, MAX_DEPTH)),
+                   std::max<std::uint64_t>(1, period / std::max<std::int64_t>(bytes, 1)),
+                   static_cast<std::uint64_t>(std::max(bytes, period)));
+        }
+        state.inside = false;
+    }
+
+    std::vector<Site> Sites() const {
+        const Inside inside;
+        std::vector<Site> sites;
+        for (const auto &a_slot : m_slots) {
+            const auto depth = a_slot.depth.load(std::memory_order_acquire);
+            if (depth) {
+                sites.push_back(Site {{a_slot.frames, a_slot.frames + depth},
+                                      a_slot.count.load(std::memory_order_relaxed),
+                                      a_slot.bytes.load(std::memory_order_relaxed)});
+            }
+        }
+        std::sort(sites.begin(), sites.end(), [](const auto &a, const auto &b) {
+            return a.bytes > b.bytes;
+        });
+        return sites;
+    }
+
+    // Writes a line per site, root first, followed by its bytes, for flamegraph.pl.
+    void WriteFolded(std::ostream &out) const {
+        const auto sites = Sites();
+        const Inside inside;
+        std::map<std::string, std::uint64_t> folded;
+        for (const auto &a_site : sites) {
+            std::string line;
+            for (auto frame = a_site.frames.rbegin(); frame != a_site.frames.rend(); ++frame) {
+                line += (line.empty() ? "" : ";") + Symbolize(*frame);
+            }
+            folded[line] += a_site.bytes;
+        }
+
+        for (const auto &[line, bytes] : folded) {
+            out << line << ' ' << bytes << '\n';
+        }
+    }
+
+private:
+    // Operator new and OnAllocation(), unless it is inlined.
+    static constexpr std::size_t SKIPPED_FRAMES = 2;
+    static constexpr int MAX_PROBES = 8;
+
+    struct ThreadState {
+        std::uint64_t allocations;
+        std::int64_t until_sample;
+        std::uint64_t random;
+        bool inside;
+    };
+
+    // Keeps the calling thread from sampling the allocations of the tracker itself.
+    class Inside {
+    public:
+        Inside() : m_previous(threadState().inside) {
+            threadState().inside = true;
+        }
+
+        ~Inside() {
+            threadState().inside = m_previous;
+        }
+
+    private:
+        const bool m_previous;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> key {0};
+        std::atomic<int> depth {0};
+        std::atomic<std::uint64_t> count {0};
+        std::atomic<std::uint64_t> bytes {0};
+        void *frames[MAX_DEPTH] {};
+    };
+
+    static ThreadState &threadState() {
+        thread_local ThreadState state {};
+        return state;
+    }
+
+    // Jitters the interval uniformly around the period, so that it cannot keep missing an
+    // allocation of a loop that allocates periodically.
+    static std::int64_t nextInterval(ThreadState &state, const std::int64_t period) {
+        if (period == 0) {
+            return 0;
+        }
+
+        if (state.random == 0) {
+            state.random = reinterpret_cast<std::uintptr_t>(&state) | 1;
+        }
+        state.random ^= state.random << 13;
+        state.random ^= state.random >> 7;
+        state.random ^= state.random << 17;
+        return period / 2 +
+               static_cast<std::int64_t>(state.random % static_cast<std::uint64_t>(period));
+    }
+
+    static std::uint64_t hash(void *const *const frames, const int depth) {
+        std::uint64_t key = 0;
+        for (auto i = 0; i < depth; ++i) {
+            key = (key ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 0x9e3779b97f4a7c15;
+            key ^= key >> 31;
+        }
+        return key | 1;
+    }
+
+    void record(void *const *const frames,
+                const int depth,
+                const std::uint64_t count,
+                const std::uint64_t bytes) {
+        const auto key = hash(frames, depth);
+        for (auto probe = 0; probe < MAX_PROBES; ++probe) {
+            auto &a_slot = m_slots[(key + probe) % SITE_COUNT];
+            auto current = a_slot.key.load(std::memory_order_acquire);
+            if (current == 0 and a_slot.key.compare_exchange_strong(current, key)) {
+                std::copy(frames, frames + depth, a_slot.frames);
+                a_slot.depth.store(depth, std::memory_order_release);
+                current = key;
+            }
+
+            if (current == key) {
+                a_slot.count.fetch_add(count, std::memory_order_relaxed);
+                a_slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+                return;
+            }
+        }
+        m_dropped.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> m_running {false};
+    std::atomic<std::int64_t> m_sample_period {DEFAULT_SAMPLE_PERIOD};
+    std::atomic<std::uint64_t> m_dropped {0};
+    Slot m_slots[SITE_COUNT];
+};
+
+// Reports the allocations the calling thread makes while it is alive. The handler aborts by
+// default, and a test can set one that fails it instead.
+class NoAllocationGuard {
+public:
+    using Handler = void (*)(const char *region, std::uint64_t allocations);
+
+    explicit NoAllocationGuard(const char *region) : m_region(region), m_start(start(region)) {
+    }
+
+    NoAllocationGuard(const NoAllocationGuard &) = delete;
+    NoAllocationGuard &operator=(const NoAllocationGuard &) = delete;
+
+    ~NoAllocationGuard() {
+        if (const auto allocations = Allocations()) {
+            handler().load(std::memory_order_acquire)(m_region, allocations);
+        }
+    }
+
+    std::uint64_t Allocations() const {
+        return AllocTracker::ThreadAllocations() - m_start;
+    }
+
+    static void SetHandler(const Handler a_handler) {
+        handler().store(a_handler, std::memory_order_release);
+    }
+
+private:
+    static std::uint64_t start(const char *region) {
+        if (not AllocTracker::Installed()) {
+            std::fprintf(stderr, "%s: the common.alloc-tracker library is not linked\n", region);
+            std::abort();
+        }
+        return AllocTracker::ThreadAllocations();
+    }
+
+    static void abortOn(const char *region, const std::uint64_t allocations) {
+        std::fprintf(stderr, "%s: %llu allocations in a no allocation region\n", region,
+                     static_cast<unsigned long long>(allocations));
+        std::abort();
+    }
+
+    static std::atomic<Handler> &handler() {
+        static std::atomic<Handler> a_handler {abortOn};
+        return a_handler;
+    }
+
+    const char *const m_region;
+    const std::uint64_t m_start;
+};
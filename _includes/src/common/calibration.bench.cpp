@@ -0,0 +1,32 @@
+// calibration.bench.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// A fixed mix of dependent arithmetic and memory copies, linked into every benchmark, which
+// the perf tests divide the other benchmarks by to factor out the speed of the machine.
+static void BM_Calibration(benchmark::State &state) {
+    constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+    constexpr int ROUNDS = 4096;
+    std::vector<char> source(BLOCK_SIZE, 'x'), target(BLOCK_SIZE);
+
+    for (auto _ : state) {
+        std::uint64_t value = 1;
+        benchmark::DoNotOptimize(value);
+        for (auto i = 0; i < ROUNDS; ++i) {
+            value ^= value << 13;
+            value ^= value >> 7;
+            value ^= value << 17;
+        }
+        benchmark::DoNotOptimize(value);
+
+        std::memcpy(target.data(), source.data(), BLOCK_SIZE);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Calibration);
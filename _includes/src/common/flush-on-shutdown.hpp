@@ -0,0 +1,38 @@
+// flush-on-shutdown.hpp
+
+#pragma once
+
+#include <streambuf>
+#include <type_traits>
+
+#include "shutdown-registry.hpp"
+
+// Keeps Base flushed by the ShutdownRegistry for as long as it lives: pubsync() for a stream
+// buffer, and Flush() for anything else. Base itself stays free of process-wide handlers.
+template<typename Base, int Priority = ShutdownRegistry::SINK_PRIORITY>
+class FlushOnShutdown : public Base {
+public:
+    using Base::Base;
+
+    FlushOnShutdown() = default;
+
+    FlushOnShutdown(const FlushOnShutdown &) = delete;
+    FlushOnShutdown &operator=(const FlushOnShutdown &) = delete;
+
+    ~FlushOnShutdown() {
+        ShutdownRegistry::Instance().Unregister(m_shutdown);
+    }
+
+private:
+    void flush() {
+        if constexpr (std::is_base_of_v<std::streambuf, Base>) {
+            this->pubsync();
+        } else {
+            this->Flush();
+        }
+    }
+
+    ShutdownRegistry::Id m_shutdown {ShutdownRegistry::Instance().Register(Priority, [this] {
+        flush();
+    })};
+};
@@ -0,0 +1,9 @@
+// hot-path.hpp
+
+#pragma once
+
+// Marks a function the benchmarks spend their time in. WANT_FUNCTION_MULTIVERSIONING defines it
+// as target_clones for FMV_TARGET_CLONES, and a test may define it first, e.g. as noinline.
+#ifndef HOT_PATH
+#define HOT_PATH
+#endif
@@ -0,0 +1,254 @@
+// perf-region.hpp
+
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+struct PerfCounts {
+    enum Counter {
+        cycles,
+        instructions,
+        cache_misses,
+        branch_misses,
+        COUNT,
+    };
+
+    std::array<std::uint64_t, COUNT> values {};
+    std::array<bool, COUNT> valid {};
+};
+
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() {
+        static constexpr std::array<std::uint64_t, PerfCounts::COUNT> CONFIGS = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+
+        for (std::size_t i = 0; i < CONFIGS.size(); ++i) {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = CONFIGS[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0);
+            if (fd == INVALID_FD) {
+                if (m_leader == INVALID_FD) {
+                    m_error = errno;
+                    return;
+                }
+                continue;
+            }
+
+            if (m_leader == INVALID_FD) {
+                m_leader = fd;
+            }
+            m_fds[i] = fd;
+        }
+    }
+
+    PerfCounterGroup(const PerfCounterGroup &) = delete;
+    PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+    ~PerfCounterGroup() {
+        for (const auto fd : m_fds) {
+            if (fd != INVALID_FD) {
+                close(fd);
+            }
+        }
+    }
+
+    auto IsAvailable() const {
+        return m_leader != INVALID_FD;
+    }
+
+    auto Error() const {
+        return m_error;
+    }
+
+    bool Read(PerfCounts &counts) const {
+        std::array<std::uint64_t, PerfCounts::COUNT + 1> buffer {};
+        if (not IsAvailable() or read(m_leader, buffer.data(), sizeof(buffer)) <= 0) {
+            return false;
+        }
+
+        for (std::size_t i = 0, n = 1; i < m_fds.size(); ++i) {
+            counts.valid[i] = m_fds[i] != INVALID_FD;
+            counts.values[i] = counts.valid[i] ? buffer[n++] : 0;
+        }
+        return true;
+    }
+
+    static auto &Local() {
+        thread_local PerfCounterGroup group;
+        return group;
+    }
+
+private:
+    static constexpr int INVALID_FD = -1;
+
+    std::array<int, PerfCounts::COUNT> m_fds {INVALID_FD, INVALID_FD, INVALID_FD, INVALID_FD};
+    int m_leader = INVALID_FD;
+    int m_error = 0;
+};
+
+struct PerfRegionStats {
+    explicit PerfRegionStats(const char *a_name) : name(a_name) {
+    }
+
+    const char *name = nullptr;
+    std::atomic<std::uint64_t> calls {0};
+    std::array<std::atomic<std::uint64_t>, PerfCounts::COUNT> totals {};
+    std::array<std::atomic<bool>, PerfCounts::COUNT> valid {};
+};
+
+class PerfRegistry {
+public:
+    static auto &Instance() {
+        static PerfRegistry registry;
+        return registry;
+    }
+
+    ~PerfRegistry() {
+        if (std::getenv("PERF_REGIONS_REPORT")) {
+            Report(std::cerr);
+        }
+    }
+
+    auto &NewRegion(const char *name) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        return m_regions.emplace_back(name);
+    }
+
+    template<typename Function>
+    void ForEach(Function &&f) const {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        for (const auto &a_region : m_regions) {
+            f(a_region);
+        }
+    }
+
+    void SetUnavailable(const int error) {
+        m_error.store(error, std::memory_order_relaxed);
+    }
+
+    void Report(std::ostream &out) const {
+        if (const auto error = m_error.load(std::memory_order_relaxed)) {
+            out << "Hardware performance counters are unavailable: " << std::strerror(error)
+                << std::endl;
+        }
+
+        out << std::left << std::setw(32) << "Region" << std::right << std::setw(12)
+            << "Calls" << std::setw(16) << "Cycles/Call" << std::setw(8) << "IPC"
+            << std::setw(16) << "Cache-Misses" << std::setw(16) << "Branch-Misses" << '\n';
+        ForEach([&out](const auto &a_region) {
+            const auto calls = a_region.calls.load();
+            const auto value = [&a_region](const auto counter) {
+                return a_region.totals[counter].load();
+            };
+            const auto field = [&a_region](const auto counter, const auto number) {
+                return a_region.valid[counter].load() ? std::to_string(number) :
+                                                        std::string {"n/a"};
+            };
+
+            out << std::left << std::setw(32) << a_region.name << std::right
+                << std::setw(12) << calls << std::setw(16)
+                << field(PerfCounts::cycles, calls ? value(PerfCounts::cycles) / calls : 0)
+                << std::setw(8) << ipc(a_region)
+                << std::setw(16)
+                << field(PerfCounts::cache_misses, value(PerfCounts::cache_misses))
+                << std::setw(16)
+                << field(PerfCounts::branch_misses, value(PerfCounts::branch_misses))
+                << '\n';
+        });
+        out.flush();
+    }
+
+private:
+    PerfRegistry() = default;
+
+    static std::string ipc(const PerfRegionStats &a_region) {
+        const auto cycles = a_region.totals[PerfCounts::cycles].load();
+        if (not cycles or not a_region.valid[PerfCounts::instructions].load()) {
+            return "n/a";
+        }
+
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2)
+            << double(a_region.totals[PerfCounts::instructions].load()) / cycles;
+        return oss.str();
+    }
+
+    mutable std::mutex m_mutex;
+    std::deque<PerfRegionStats> m_regions;
+    std::atomic<int> m_error {0};
+};
+
+class PerfRegion {
+public:
+    explicit PerfRegion(PerfRegionStats &stats) :
+        m_stats(stats), m_started(PerfCounterGroup::Local().Read(m_start)) {
+        if (not m_started) {
+            PerfRegistry::Instance().SetUnavailable(PerfCounterGroup::Local().Error());
+        }
+    }
+
+    PerfRegion(const PerfRegion &) = delete;
+    PerfRegion &operator=(const PerfRegion &) = delete;
+
+    ~PerfRegion() {
+        m_stats.calls.fetch_add(1, std::memory_order_relaxed);
+
+        PerfCounts end;
+        if (m_started and PerfCounterGroup::Local().Read(end)) {
+            for (std::size_t i = 0; i < end.values.size(); ++i) {
+                if (end.valid[i]) {
+                    m_stats.totals[i].fetch_add(end.values[i] - m_start.values[i],
+                                                std::memory_order_relaxed);
+                    m_stats.valid[i].store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+private:
+    PerfRegionStats &m_stats;
+    PerfCounts m_start;
+    bool m_started = false;
+};
+
+#ifdef PERF_COUNTERS
+
+#define PERF_CONCAT_IMPL(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_IMPL(a, b)
+#define PERF_REGION(name)                                         \
+    static auto &PERF_CONCAT(perf_stats_, __LINE__) =             \
+        PerfRegistry::Instance().NewRegion(name);                 \
+    const PerfRegion PERF_CONCAT(perf_region_, __LINE__) {        \
+        PERF_CONCAT(perf_stats_, __LINE__)}
+
+#else
+
+#define PERF_REGION(name) static_cast<void>(0)
+
+#endif
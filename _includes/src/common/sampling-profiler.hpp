@@ -0,0 +1,314 @@
+// sampling-profiler.hpp
+
+#pragma once
+
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shutdown-registry.hpp"
+#include "symbolize.hpp"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+// An opt-in sampling profiler. Every profiled thread has a timer on its own CPU clock that
+// sends it SIGPROF, and the handler copies the raw frames into a free slot of a preallocated
+// ring, without locks or allocations. Between Start() and Stop(), a background thread aggregates
+// identical stacks once a second, and they are symbolized only when written as folded stacks,
+// for flamegraph.pl.
+class SamplingProfiler {
+public:
+    static constexpr int DEFAULT_HZ = 100;
+    static constexpr std::size_t MAX_DEPTH = 64;
+    static constexpr std::size_t SLOT_COUNT = 4096;
+
+    // Never destroyed, as a signal may still arrive during the exit.
+    static SamplingProfiler &Instance() {
+        static auto *profiler = new SamplingProfiler;
+        return *profiler;
+    }
+
+    // Profiles the calling thread; other threads join with ProfileThisThread().
+    void Start(const int hz = DEFAULT_HZ) {
+        m_interval_ns.store(NANOSECONDS_PER_SECOND / std::max(hz, 1), std::memory_order_relaxed);
+        installHandler();
+        m_running.store(true, std::memory_order_release);
+        ProfileThisThread();
+
+        std::lock_guard<std::mutex> guard {m_control_mutex};
+        if (not m_aggregator.joinable()) {
+            m_stop_aggregator = false;
+            m_aggregator = std::thread {[this] {
+                aggregate();
+            }};
+        }
+    }
+
+    void ProfileThisThread() {
+        auto &timer = threadTimer();
+        std::lock_guard<std::mutex> guard {m_timers_mutex};
+        m_timers.insert(&timer);
+        timer.Arm(m_interval_ns.load(std::memory_order_relaxed));
+    }
+
+    // Disarms the timers of all profiled threads, which rejoin with ProfileThisThread(), and
+    // waits for the background thread, so its last drain is over when this returns.
+    void Stop() {
+        m_running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> guard {m_timers_mutex};
+            for (auto *a_timer : m_timers) {
+                a_timer->Arm(0);
+            }
+            m_timers.clear();
+        }
+
+        std::lock_guard<std::mutex> guard {m_control_mutex};
+        if (m_aggregator.joinable()) {
+            {
+                std::lock_guard<std::mutex> stop_guard {m_stop_mutex};
+                m_stop_aggregator = true;
+            }
+            m_stop_cv.notify_one();
+            m_aggregator.join();
+        }
+    }
+
+    std::uint64_t Samples() const {
+        return m_samples.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    // The CPU time spent in the signal handler, relative to the CPU time sampled.
+    double Overhead() const {
+        const auto sampled = static_cast<double>(Samples()) *
+                             static_cast<double>(m_interval_ns.load(std::memory_order_relaxed));
+        return sampled ? static_cast<double>(m_handler_ns.load(std::memory_order_relaxed)) /
+                             sampled
+                       : 0.0;
+    }
+
+    // Writes a line per distinct stack, root first, followed by its number of samples.
+    void WriteFolded(std::ostream &out) {
+        std::lock_guard<std::mutex> guard {m_stacks_mutex};
+        drain();
+
+        std::map<std::string, std::uint64_t> folded;
+        for (const auto &[a_stack, count] : m_stacks) {
+            std::string line;
+            for (auto frame = a_stack.rbegin(); frame != a_stack.rend(); ++frame) {
+                line += (line.empty() ? "" : ";") + symbolOf(*frame);
+            }
+            folded[line] += count;
+        }
+
+        for (const auto &[line, count] : folded) {
+            out << line << ' ' << count << '\n';
+        }
+    }
+
+    // Replaces the path of an earlier call.
+    void WriteAtExit(const std::string path) {
+        auto &registry = ShutdownRegistry::Instance();
+        std::lock_guard<std::mutex> guard {m_control_mutex};
+        registry.Unregister(m_write_at_exit);
+        m_write_at_exit = registry.Register(ShutdownRegistry::SINK_PRIORITY, [this, path] {
+            Stop();
+            std::ofstream out {path};
+            WriteFolded(out);
+        });
+    }
+
+private:
+    static constexpr long NANOSECONDS_PER_SECOND = 1'000'000'000;
+    static constexpr std::chrono::seconds AGGREGATION_PERIOD {1};
+    static constexpr int SKIPPED_FRAMES = 2;
+
+    enum State : int {
+        empty,
+        writing,
+        full,
+    };
+
+    struct Slot {
+        std::atomic<int> state {empty};
+        int depth = 0;
+        void *frames[MAX_DEPTH];
+    };
+
+    class ThreadTimer {
+    public:
+        ThreadTimer() {
+            sigevent event {};
+            event.sigev_notify = SIGEV_THREAD_ID;
+            event.sigev_signo = SIGPROF;
+            event.sigev_notify_thread_id = static_cast<pid_t>(::syscall(SYS_gettid));
+            m_valid = ::timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &m_timer) == 0;
+        }
+
+        ThreadTimer(const ThreadTimer &) = delete;
+        ThreadTimer &operator=(const ThreadTimer &) = delete;
+
+        // Runs at the exit of its thread, so Stop() must no longer reach it.
+        ~ThreadTimer() {
+            auto &profiler = Instance();
+            {
+                std::lock_guard<std::mutex> guard {profiler.m_timers_mutex};
+                profiler.m_timers.erase(this);
+            }
+            if (m_valid) {
+                ::timer_delete(m_timer);
+            }
+        }
+
+        void Arm(const long interval_ns) {
+            if (m_valid) {
+                itimerspec spec {};
+                spec.it_interval.tv_sec = interval_ns / NANOSECONDS_PER_SECOND;
+                spec.it_interval.tv_nsec = interval_ns % NANOSECONDS_PER_SECOND;
+                spec.it_value = spec.it_interval;
+                ::timer_settime(m_timer, 0, &spec, nullptr);
+            }
+        }
+
+    private:
+        timer_t m_timer {};
+        bool m_valid = false;
+    };
+
+    SamplingProfiler() : m_slots(std::make_unique<Slot[]>(SLOT_COUNT)) {
+    }
+
+    static ThreadTimer &threadTimer() {
+        thread_local ThreadTimer timer;
+        return timer;
+    }
+
+    static std::int64_t threadCpuNanoseconds() {
+        timespec now {};
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+    }
+
+    void installHandler() {
+        std::call_once(m_installed, [] {
+            // The first backtrace() may load the unwinder, which is not safe in a handler.
+            void *frame = nullptr;
+            ::backtrace(&frame, 1);
+
+            struct sigaction action {};
+            action.sa_handler = onSignal;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            ::sigaction(SIGPROF, &action, nullptr);
+        });
+    }
+
+    void aggregate() {
+        std::unique_lock<std::mutex> lock {m_stop_mutex};
+        while (not m_stop_cv.wait_for(lock, AGGREGATION_PERIOD, [this] {
+            return m_stop_aggregator;
+        })) {
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> guard {m_stacks_mutex};
+                drain();
+            }
+            lock.lock();
+        }
+    }
+
+    // Takes the backtrace itself, so that its frame and the signal trampoline are the first two.
+    static void onSignal(int) {
+        const auto saved_errno = errno;
+        auto &profiler = Instance();
+        if (profiler.m_running.load(std::memory_order_acquire)) {
+            const auto started = threadCpuNanoseconds();
+            void *frames[MAX_DEPTH];
+            profiler.store(frames, ::backtrace(frames, MAX_DEPTH));
+            profiler.m_handler_ns.fetch_add(threadCpuNanoseconds() - started,
+                                            std::memory_order_relaxed);
+        }
+        errno = saved_errno;
+    }
+
+    void store(void *const *const frames, const int depth) {
+        auto &a_slot = m_slots[m_next.fetch_add(1, std::memory_order_relaxed) % SLOT_COUNT];
+        auto state = static_cast<int>(empty);
+        if (a_slot.state.compare_exchange_strong(state, writing, std::memory_order_acquire)) {
+            std::copy(frames, frames + depth, a_slot.frames);
+            a_slot.depth = depth;
+            a_slot.state.store(full, std::memory_order_release);
+            m_samples.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void drain() {
+        for (std::size_t i = 0; i < SLOT_COUNT; ++i) {
+            auto &a_slot = m_slots[i];
+            if (a_slot.state.load(std::memory_order_acquire) == full) {
+                const auto first = std::min(a_slot.depth, SKIPPED_FRAMES);
+                ++m_stacks[std::vector<void *>(a_slot.frames + first,
+                                               a_slot.frames + a_slot.depth)];
+                a_slot.state.store(empty, std::memory_order_release);
+            }
+        }
+    }
+
+    std::string symbolOf(void *const address) {
+        auto &symbol = m_symbols[address];
+        if (symbol.empty()) {
+            symbol = Symbolize(address);
+        }
+        return symbol;
+    }
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<std::uint64_t> m_next {0};
+    std::atomic<std::uint64_t> m_samples {0};
+    std::atomic<std::uint64_t> m_dropped {0};
+    std::atomic<std::int64_t> m_handler_ns {0};
+    std::atomic<long> m_interval_ns {NANOSECONDS_PER_SECOND / DEFAULT_HZ};
+    std::atomic<bool> m_running {false};
+    std::once_flag m_installed;
+
+    std::mutex m_stacks_mutex;
+    std::map<std::vector<void *>, std::uint64_t> m_stacks;
+    std::map<void *, std::string> m_symbols;
+
+    std::mutex m_timers_mutex;
+    std::set<ThreadTimer *> m_timers;
+
+    std::mutex m_control_mutex;
+    std::thread m_aggregator;
+    ShutdownRegistry::Id m_write_at_exit = 0;
+
+    std::mutex m_stop_mutex;
+    std::condition_variable m_stop_cv;
+    bool m_stop_aggregator = false;
+};
@@ -0,0 +1,214 @@
+// shutdown-registry.hpp
+
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Flushes buffered state when the program ends: main returns, exit() is called, main catches
+// an ExitException and returns its code, or std::terminate() is called. Callbacks run once on the
+// thread that ends the program, highest priority first. If one overruns its deadline or what is
+// left of the budget, a watchdog ends the process with _exit(EXIT_FAILURE), so a stuck sink can
+// neither hang the exit nor outlive the objects it flushes.
+class ShutdownRegistry {
+public:
+    using Id = std::uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr int SINK_PRIORITY = 0;
+    static constexpr int QUEUE_PRIORITY = 100;
+    static constexpr std::chrono::milliseconds DEFAULT_DEADLINE {100};
+    static constexpr std::chrono::milliseconds DEFAULT_BUDGET {1000};
+
+    ShutdownRegistry() = default;
+
+    ShutdownRegistry(const ShutdownRegistry &) = delete;
+    ShutdownRegistry &operator=(const ShutdownRegistry &) = delete;
+
+    // Never destroyed, so it is still there for the exit handlers.
+    static ShutdownRegistry &Instance() {
+        static auto *registry = [] {
+            auto *registry = new ShutdownRegistry;
+            std::atexit([] {
+                Instance().Run();
+            });
+            previousTerminate() = std::set_terminate(onTerminate);
+            return registry;
+        }();
+        return *registry;
+    }
+
+    Id Register(const int priority,
+                Callback callback,
+                const std::chrono::milliseconds deadline = DEFAULT_DEADLINE) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        m_entries.push_back(Entry {++m_last_id, priority, deadline, std::move(callback)});
+        return m_last_id;
+    }
+
+    // Once this returns, the callback is neither running nor will it run, unless the caller is
+    // the callback itself.
+    void Unregister(const Id id) {
+        std::unique_lock<std::mutex> lock {m_mutex};
+        m_entries.erase(std::remove_if(m_entries.begin(),
+                                       m_entries.end(),
+                                       [id](const auto &an_entry) {
+                                           return an_entry.id == id;
+                                       }),
+                        m_entries.end());
+        m_idle.wait(lock, [this, id] {
+            return m_running != id or m_runner == std::this_thread::get_id();
+        });
+    }
+
+    void SetBudget(const std::chrono::milliseconds budget) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        m_budget = budget;
+    }
+
+    // Runs the callbacks registered by now and not unregistered before their turn, and does
+    // nothing on later calls. Returns how many ran.
+    std::size_t Run() {
+        if (m_ran.exchange(true)) {
+            return 0;
+        }
+
+        std::vector<Entry> entries;
+        auto budget = DEFAULT_BUDGET;
+        {
+            std::lock_guard<std::mutex> guard {m_mutex};
+            entries = m_entries;
+            budget = m_budget;
+        }
+        std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+            return a.priority > b.priority;
+        });
+
+        const auto end = std::chrono::steady_clock::now() + budget;
+        Watchdog watchdog {end};
+        std::size_t ran = 0;
+        for (const auto &an_entry : entries) {
+            if (not start(an_entry.id)) {
+                continue;
+            }
+            watchdog.Arm(std::min(std::chrono::steady_clock::now() + an_entry.deadline, end));
+            an_entry.callback();
+            finish();
+            ++ran;
+        }
+        return ran;
+    }
+
+private:
+    struct Entry {
+        Id id = 0;
+        int priority = 0;
+        std::chrono::milliseconds deadline;
+        Callback callback;
+    };
+
+    // Ends the process unless it is re-armed or destroyed before the deadline.
+    class Watchdog {
+    public:
+        explicit Watchdog(const std::chrono::steady_clock::time_point deadline) :
+            m_deadline(deadline), m_thread([this] {
+                watch();
+            }) {
+        }
+
+        Watchdog(const Watchdog &) = delete;
+        Watchdog &operator=(const Watchdog &) = delete;
+
+        ~Watchdog() {
+            {
+                std::lock_guard<std::mutex> guard {m_mutex};
+                m_stopped = true;
+            }
+            m_condition.notify_one();
+            m_thread.join();
+        }
+
+        void Arm(const std::chrono::steady_clock::time_point deadline) {
+            {
+                std::lock_guard<std::mutex> guard {m_mutex};
+                m_deadline = deadline;
+                ++m_generation;
+            }
+            m_condition.notify_one();
+        }
+
+    private:
+        void watch() {
+            std::unique_lock<std::mutex> lock {m_mutex};
+            while (not m_stopped) {
+                const auto generation = m_generation;
+                if (m_condition.wait_until(lock, m_deadline) == std::cv_status::timeout and
+                    not m_stopped and generation == m_generation) {
+                    _exit(EXIT_FAILURE);
+                }
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::chrono::steady_clock::time_point m_deadline;
+        std::uint64_t m_generation = 0;
+        bool m_stopped = false;
+        std::thread m_thread;
+    };
+
+    // Marks the entry as running, if it is still registered.
+    bool start(const Id id) {
+        std::lock_guard<std::mutex> guard {m_mutex};
+        if (std::none_of(m_entries.begin(), m_entries.end(), [id](const auto &an_entry) {
+                return an_entry.id == id;
+            })) {
+            return false;
+        }
+        m_running = id;
+        m_runner = std::this_thread::get_id();
+        return true;
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> guard {m_mutex};
+            m_running = 0;
+        }
+        m_idle.notify_all();
+    }
+
+    static std::terminate_handler &previousTerminate() {
+        static std::terminate_handler handler = nullptr;
+        return handler;
+    }
+
+    [[noreturn]] static void onTerminate() noexcept {
+        Instance().Run();
+        if (const auto previous = previousTerminate()) {
+            previous();
+        }
+        std::abort();
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::vector<Entry> m_entries;
+    Id m_last_id = 0;
+    Id m_running = 0;
+    std::thread::id m_runner;
+    std::chrono::milliseconds m_budget = DEFAULT_BUDGET;
+    std::atomic<bool> m_ran {false};
+};
@@ -0,0 +1,31 @@
+// symbolize.hpp
+
+#pragma once
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+
+// The demangled name of the function at an address, or the address itself when it is not an
+// exported symbol. ';' is replaced, as it separates the frames of a folded stack.
+inline std::string Symbolize(void *const address) {
+    std::string symbol;
+    Dl_info info {};
+    if (::dladdr(address, &info) and info.dli_sname) {
+        int status = 0;
+        std::unique_ptr<char, decltype(&std::free)> demangled {
+            abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free};
+        symbol = status == 0 ? demangled.get() : info.dli_sname;
+    } else {
+        std::ostringstream hex;
+        hex << address;
+        symbol = hex.str();
+    }
+    std::replace(symbol.begin(), symbol.end(), ';', ':');
+    return symbol;
+}
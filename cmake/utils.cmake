@@ -9,6 +9,23 @@ macro (CONFIG_CXX_COMPILER_AND_LINKER std)
     if (result)
         set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
     endif ()
+
+    if (CXX_MARCH)
+        add_compile_options(-march=${CXX_MARCH})
+    endif ()
+
+    if (PGO_MODE STREQUAL "GENERATE")
+        add_compile_options(-fprofile-generate=${PGO_PROFILE_DIR} -fprofile-update=atomic)
+        add_link_options(-fprofile-generate=${PGO_PROFILE_DIR})
+    elseif (PGO_MODE STREQUAL "USE")
+        add_compile_options(-fprofile-use=${PGO_PROFILE_DIR})
+        if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+            add_compile_options(-fprofile-correction -Wno-missing-profile)
+        else ()
+            add_compile_options(-Wno-profile-instr-unprofiled)
+        endif ()
+        add_link_options(-fprofile-use=${PGO_PROFILE_DIR})
+    endif ()
 endmacro ()
 
 # enable_auto_test_command
@@ -58,6 +75,60 @@ function (discover_gtest_for source_name)
     endif ()
 endfunction ()
 
+# add_benchmark_for
+function (add_benchmark_for source_name)
+    if (WANT_BENCHMARKS)
+        set(bench_source_name "${source_name}.bench")
+        set(target_name "${PROJECT_NAME}.${bench_source_name}")
+        add_executable(${target_name} ${bench_source_name}.cpp)
+        target_link_libraries(${target_name} PRIVATE benchmark::benchmark_main
+                                                     common.bench-calibration ${ARGN})
+        target_compile_options(${target_name} PRIVATE ${COMPILER_WARNING_OPTIONS})
+
+        set(json_file "${BENCHMARK_OUTPUT_DIR}/${target_name}.json")
+        add_custom_target(
+            ${target_name}.json
+            COMMAND ${target_name} --benchmark_out=${json_file}
+                    --benchmark_out_format=json
+            BYPRODUCTS ${json_file}
+            WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+            COMMENT "Benchmarking '${target_name}'"
+            VERBATIM)
+        add_dependencies(benchmarks ${target_name}.json)
+
+        add_perf_test_for(${target_name}
+                          "${CMAKE_CURRENT_SOURCE_DIR}/${bench_source_name}.baseline.json")
+    endif ()
+endfunction ()
+
+# add_perf_test_for
+function (add_perf_test_for target_name baseline_file)
+    if (NOT Python3_Interpreter_FOUND)
+        return()
+    endif ()
+
+    set(compare_command
+        Python3::Interpreter ${BENCHMARK_COMPARE_SCRIPT} --benchmark
+        $<TARGET_FILE:${target_name}> --baseline ${baseline_file} --repetitions
+        ${PERF_TEST_REPETITIONS} --tolerance ${PERF_TEST_TOLERANCE})
+
+    add_custom_target(
+        ${target_name}.baseline
+        COMMAND ${compare_command} --update
+        DEPENDS ${target_name}
+        COMMENT "Updating baseline of '${target_name}'"
+        VERBATIM)
+    add_dependencies(update-baselines ${target_name}.baseline)
+
+    if (WANT_TESTS AND WANT_PERF_TESTS)
+        set(test_name "${target_name}.perf-test")
+        add_test(NAME ${test_name} COMMAND ${compare_command})
+        set_tests_properties(${test_name} PROPERTIES LABELS perf RUN_SERIAL ON)
+
+        enable_auto_test_command(${target_name} ^${test_name}$)
+    endif ()
+endfunction ()
+
 # cmake-lint: disable=C0307
 
 # add_single_executable
@@ -77,6 +148,12 @@ function (add_runnable_test main_name)
         set(test_name "${PROJECT_NAME}.${main_name}.runnable-test")
 
         add_test(NAME ${test_name} COMMAND ${target_name})
+        if (WANT_PERF_COUNTERS)
+            set_property(
+                TEST ${test_name}
+                APPEND
+                PROPERTY ENVIRONMENT "PERF_REGIONS_REPORT=1")
+        endif ()
 
         enable_auto_test_command(${target_name} ^${test_name}$)
     endif ()
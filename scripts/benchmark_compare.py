@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+
+# benchmark_compare.py
+
+"""
+Compare google benchmark results against a stored baseline.
+
+Every benchmark is run --repetitions times and only the median is compared, as
+a ratio to the median of the BM_Calibration benchmark linked into every
+benchmark executable, so that a baseline recorded on one machine holds on
+another. A benchmark regresses when its ratio falls below the baseline by more
+than max(tolerance, min(NOISE_FACTOR * noise, MAX_NOISE_ALLOWANCE)), where noise
+is the larger coefficient of variation of that benchmark in the two runs. A
+noisy benchmark thus never widens the allowance of the others, and the cap
+keeps it from hiding a large drop of its own.
+
+A missing baseline, or a benchmark missing from either side, fails the
+comparison. --update records a new baseline, and requires a --reason, which is
+stored with it.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+NOISE_FACTOR = 2.0
+MAX_NOISE_ALLOWANCE = 0.25
+CALIBRATION = "BM_Calibration"
+THROUGHPUT_COUNTERS = ("bytes_per_second", "items_per_second")
+
+
+def throughput_of(run):
+    for counter in THROUGHPUT_COUNTERS:
+        if counter in run:
+            return counter, run[counter]
+    return "1/real_time", 1.0 / run["real_time"] if run["real_time"] else 0.0
+
+
+def summarize(raw):
+    aggregates = {}
+    for run in raw["benchmarks"]:
+        if run.get("run_type") == "aggregate":
+            aggregates.setdefault(run["run_name"], {})[run["aggregate_name"]] = run
+
+    if not aggregates:
+        for run in raw["benchmarks"]:
+            aggregates[run["run_name"]] = {"median": run, "cv": {"real_time": 0.0}}
+
+    summary = {}
+    for name, runs in aggregates.items():
+        metric, median = throughput_of(runs["median"])
+        if "cv" in runs:
+            cv = runs["cv"]["real_time"]
+        elif runs["mean"]["real_time"]:
+            cv = runs["stddev"]["real_time"] / runs["mean"]["real_time"]
+        else:
+            cv = 0.0
+        summary[name] = {"metric": metric, "median": median, "cv": abs(cv)}
+
+    return summary
+
+
+def run_benchmark(executable, repetitions, extra_args):
+    with tempfile.NamedTemporaryFile(suffix=".json") as out:
+        subprocess.run(
+            [
+                executable,
+                f"--benchmark_repetitions={repetitions}",
+                "--benchmark_report_aggregates_only=true",
+                f"--benchmark_out={out.name}",
+                "--benchmark_out_format=json",
+            ]
+            + extra_args,
+            check=True,
+            stdout=subprocess.DEVNULL,
+        )
+        return json.load(out)
+
+
+def load_results(path):
+    with open(path) as f:
+        raw = json.load(f)
+    if "context" in raw:
+        return summarize(raw)
+    return raw["benchmarks"]
+
+
+def compare(baseline, current, tolerance):
+    failures = []
+    for results in (baseline, current):
+        if CALIBRATION not in results or not results[CALIBRATION]["median"]:
+            return [f"{CALIBRATION} is missing"]
+    base_calibration = baseline[CALIBRATION]
+    now_calibration = current[CALIBRATION]
+
+    print(f"{'Benchmark':<64} {'Baseline':>12} {'Current':>12} {'Change':>8} {'Allowed':>8}")
+    for name in sorted((set(baseline) | set(current)) - {CALIBRATION}):
+        if name not in current:
+            print(f"{name:<64} {'missing':>12}")
+            failures.append(f"{name} is missing")
+            continue
+        if name not in baseline:
+            print(f"{name:<64} {'new':>12}")
+            failures.append(f"{name} has no baseline")
+            continue
+
+        base = baseline[name]["median"] / base_calibration["median"]
+        now = current[name]["median"] / now_calibration["median"]
+        change = now / base - 1.0 if base else 0.0
+        noise = max(baseline[name]["cv"], current[name]["cv"])
+        allowed = max(tolerance, min(NOISE_FACTOR * noise, MAX_NOISE_ALLOWANCE))
+        print(f"{name:<64} {base:>12.4g} {now:>12.4g} {change:>+8.1%} {-allowed:>+8.1%}")
+        if change < -allowed:
+            failures.append(f"{name} regressed")
+
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--baseline", required=True, help="The stored baseline file.")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--benchmark", help="The benchmark executable to run.")
+    source.add_argument("--current", help="Previously recorded benchmark JSON.")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument(
+        "--tolerance",
+        type=float,
+        default=0.1,
+        help="The minimum relative throughput drop treated as a regression.",
+    )
+    parser.add_argument(
+        "--update",
+        action="store_true",
+        default=os.environ.get("PERF_UPDATE_BASELINE") == "1",
+        help="Overwrite the baseline with the current results.",
+    )
+    parser.add_argument(
+        "--reason",
+        default=os.environ.get("PERF_BASELINE_REASON"),
+        help="Why the baseline is updated, which is required with --update.",
+    )
+    parser.add_argument(
+        "--report",
+        action="store_true",
+        help="Only report the changes, never fail on a regression.",
+    )
+    parser.add_argument("benchmark_args", nargs="*")
+    args = parser.parse_args()
+
+    if args.update and not args.reason:
+        print("A baseline update needs a --reason", file=sys.stderr)
+        return 1
+    if not args.update and not os.path.exists(args.baseline):
+        print(f"No baseline: {args.baseline}", file=sys.stderr)
+        return 1
+
+    if args.benchmark:
+        current = summarize(
+            run_benchmark(args.benchmark, args.repetitions, args.benchmark_args)
+        )
+    else:
+        current = load_results(args.current)
+
+    if args.update:
+        if CALIBRATION not in current:
+            print(f"{CALIBRATION} is missing", file=sys.stderr)
+            return 1
+
+        with open(args.baseline, "w") as f:
+            json.dump(
+                {"reason": args.reason, "benchmarks": current}, f, indent=4, sort_keys=True
+            )
+            f.write("\n")
+        print(f"Baseline updated: {args.baseline}")
+        return 0
+
+    failures = compare(load_results(args.baseline), current, args.tolerance)
+    for failure in failures:
+        print(f"Failure: {failure}", file=sys.stderr)
+
+    return 1 if failures and not args.report else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
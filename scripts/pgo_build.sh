@@ -0,0 +1,69 @@
+#!/bin/bash
+
+#
+# This script does a two-stage profile-guided optimization build, trained by the
+# runnable tests and the benchmarks, and reports the speedup of every benchmark
+# over the plain IPO build.
+#
+# Usage: pgo_build.sh [build root] [extra cmake options...]
+#
+
+set -e
+
+THIS_DIR=$(dirname "$0")
+source "$THIS_DIR/utils.sh"
+
+QuietRun pushd "$THIS_DIR"
+PROJECT_ROOT_DIR=$(GetProjectRootDir)
+QuietRun popd
+
+BUILD_ROOT=$(realpath "${1:-$PROJECT_ROOT_DIR/build-pgo}")
+CMAKE_OPTIONS=(-DCMAKE_BUILD_TYPE:STRING=Release -DWANT_AUTO_TESTS:BOOL=OFF "${@:2}")
+REPETITIONS=${PGO_REPETITIONS:-5}
+
+IPO_DIR=$BUILD_ROOT/ipo
+PGO_DIR=$BUILD_ROOT/pgo
+PROFILE_DIR=$BUILD_ROOT/profiles
+
+ConfigureAndBuild() {
+    local build_dir=$1
+    shift
+
+    cmake -S "$PROJECT_ROOT_DIR" -B "$build_dir" "${CMAKE_OPTIONS[@]}" "$@"
+    cmake --build "$build_dir" -j "$(nproc)"
+}
+
+RunBenchmarks() {
+    local build_dir=$1
+    local output_dir=$2
+
+    mkdir -p "$output_dir"
+    for a_benchmark in $(find "$build_dir/_includes" -type f -executable -name '*.bench'); do
+        "$a_benchmark" --benchmark_repetitions="$REPETITIONS" \
+            --benchmark_report_aggregates_only=true \
+            --benchmark_out="$output_dir/$(basename "$a_benchmark").json" \
+            --benchmark_out_format=json > /dev/null
+    done
+}
+
+ConfigureAndBuild "$IPO_DIR" -DPGO_MODE:STRING=
+RunBenchmarks "$IPO_DIR" "$BUILD_ROOT/results/ipo"
+
+rm -rf "$PROFILE_DIR"
+ConfigureAndBuild "$PGO_DIR" -DPGO_MODE:STRING=GENERATE -DPGO_PROFILE_DIR:PATH="$PROFILE_DIR"
+ctest --test-dir "$PGO_DIR" -R runnable-test > /dev/null || true
+REPETITIONS=1 RunBenchmarks "$PGO_DIR" "$BUILD_ROOT/results/training"
+
+if compgen -G "$PROFILE_DIR/*.profraw" > /dev/null; then
+    llvm-profdata merge -output="$PROFILE_DIR/default.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+ConfigureAndBuild "$PGO_DIR" -DPGO_MODE:STRING=USE
+RunBenchmarks "$PGO_DIR" "$BUILD_ROOT/results/pgo"
+
+for ipo_result in "$BUILD_ROOT"/results/ipo/*.json; do
+    echo "Speedup of $(basename "$ipo_result" .json) over the plain IPO build:"
+    python3 "$THIS_DIR/benchmark_compare.py" --report --baseline "$ipo_result" \
+        --current "$BUILD_ROOT/results/pgo/$(basename "$ipo_result")"
+    echo
+done